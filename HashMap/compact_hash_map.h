@@ -0,0 +1,757 @@
+#ifndef HASHMAP_COMPACT_HASH_MAP_H
+#define HASHMAP_COMPACT_HASH_MAP_H
+
+
+#pragma once
+
+#include "hash_map.h"
+
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+
+namespace fefu
+{
+
+    /**
+     *  Node storage of a %compact_hash_map, addressed by 32-bit indices.
+     *
+     *  Slab k holds 16 << k nodes, so the slabs grow with the map, never
+     *  move once allocated, and an index finds its slab with one bit scan.
+     *  Freed indices are recycled through a free list threaded through the
+     *  cached hash of the free nodes. Elements are constructed and
+     *  destroyed by the owning map; the arena only hands out memory.
+     */
+    template<typename Node, typename Alloc>
+    class hash_map_node_arena {
+    public:
+        using size_type = std::size_t;
+        using index_type = std::uint32_t;
+        using allocator_type = typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+
+        /// Largest number of nodes the arena can hand out.
+        static constexpr index_type max_nodes = std::numeric_limits<index_type>::max();
+
+        explicit hash_map_node_arena(const allocator_type& a) : node_allocator(a) {}
+
+        hash_map_node_arena(const hash_map_node_arena&) = delete;
+        hash_map_node_arena& operator=(const hash_map_node_arena&) = delete;
+
+        hash_map_node_arena(hash_map_node_arena&& other) noexcept
+        : node_allocator(std::move(other.node_allocator)) {
+            steal_helper(other);
+        }
+
+        ~hash_map_node_arena() {
+            release();
+        }
+
+        Node* node(index_type i) const noexcept {
+            std::uint64_t j = std::uint64_t(i) + first_slab_size;
+            size_type k = slab_helper(j);
+            return slabs[k] + (j - (first_slab_size << k));
+        }
+
+        /// Returns the index of an unused node.
+        /// @throw  std::length_error  If all 32-bit indices are in use.
+        index_type allocate() {
+            if(free_head != max_nodes) {
+                index_type i = free_head;
+                free_head = node(i)->hash.first;
+                return i;
+            }
+            if(fresh == max_nodes)
+                throw std::length_error("hash_map_node_arena is full");
+            size_type k = slab_helper(std::uint64_t(fresh) + first_slab_size);
+            if(slabs[k] == nullptr)
+                slabs[k] = node_alloc_traits::allocate(node_allocator, first_slab_size << k);
+            return fresh++;
+        }
+
+        void deallocate(index_type i) noexcept {
+            node(i)->hash.first = free_head;
+            free_head = i;
+        }
+
+        /// Returns every slab to the allocator.
+        void release() noexcept {
+            for(size_type k = 0; k < slab_count; k++) {
+                if(slabs[k] != nullptr)
+                    node_alloc_traits::deallocate(node_allocator, slabs[k], first_slab_size << k);
+                slabs[k] = nullptr;
+            }
+            fresh = 0;
+            free_head = max_nodes;
+        }
+
+        /// Returns the bytes held in slabs.
+        size_type capacity_bytes() const noexcept {
+            size_type bytes = 0;
+            for(size_type k = 0; k < slab_count; k++) {
+                if(slabs[k] != nullptr)
+                    bytes += (first_slab_size << k) * sizeof(Node);
+            }
+            return bytes;
+        }
+
+        allocator_type get_allocator() const noexcept {
+            return node_allocator;
+        }
+
+        /// Swaps slabs with another arena, and allocators too unless told not to.
+        void swap(hash_map_node_arena& other, bool allocators = true) noexcept {
+            if(allocators)
+                std::swap(node_allocator, other.node_allocator);
+            for(size_type k = 0; k < slab_count; k++)
+                std::swap(slabs[k], other.slabs[k]);
+            std::swap(fresh, other.fresh);
+            std::swap(free_head, other.free_head);
+        }
+
+    private:
+        using node_alloc_traits = std::allocator_traits<allocator_type>;
+
+        static constexpr std::uint64_t first_slab_size = 16;
+        // Enough slabs for every index below max_nodes.
+        static constexpr size_type slab_count = 29;
+
+        // Slab of the biased index j = i + first_slab_size.
+        static size_type slab_helper(std::uint64_t j) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<size_type>(63 - __builtin_clzll(j)) - 4;
+#else
+            size_type log = 0;
+            while(j >>= 1)
+                log++;
+            return log - 4;
+#endif
+        }
+
+        void steal_helper(hash_map_node_arena& other) noexcept {
+            for(size_type k = 0; k < slab_count; k++) {
+                slabs[k] = other.slabs[k];
+                other.slabs[k] = nullptr;
+            }
+            fresh = other.fresh;
+            free_head = other.free_head;
+            other.fresh = 0;
+            other.free_head = max_nodes;
+        }
+
+        allocator_type node_allocator;
+        Node* slabs[slab_count] = {};
+        index_type fresh = 0;
+        index_type free_head = max_nodes;
+    };
+
+    template<typename Node, typename Alloc>
+    constexpr typename hash_map_node_arena<Node, Alloc>::index_type hash_map_node_arena<Node, Alloc>::max_nodes;
+
+    template<typename Node, typename Alloc>
+    constexpr std::uint64_t hash_map_node_arena<Node, Alloc>::first_slab_size;
+
+    template<typename Node, typename Alloc>
+    constexpr std::size_t hash_map_node_arena<Node, Alloc>::slab_count;
+
+
+    /**
+     *  Iterator of a %compact_hash_map. Like the %hash_map iterators it
+     *  hands out the element pointer, which it finds through the node
+     *  arena.
+     */
+    template<typename ValueType, typename Arena>
+    class compact_hash_map_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ValueType;
+        using difference_type = std::ptrdiff_t;
+        using reference = ValueType*;
+        using pointer = ValueType*;
+        using node_type = hash_map_node<typename std::remove_const<ValueType>::type>;
+        using group_type = hash_map_slot_group<node_type, typename Arena::index_type>;
+
+        compact_hash_map_iterator() noexcept {}
+
+        compact_hash_map_iterator(const group_type* groups, const Arena* arena, size_t cur_index, size_t size) noexcept
+        : groups(groups), arena(arena), cur_index(cur_index), size(size) {}
+
+        template<typename U, typename = typename std::enable_if<std::is_same<const U, ValueType>::value>::type>
+        compact_hash_map_iterator(const compact_hash_map_iterator<U, Arena>& other) noexcept
+        : groups(other.groups), arena(other.arena), cur_index(other.cur_index), size(other.size) {}
+
+        reference operator*() const {
+            return arena->node(groups[cur_index / group_type::width].slots[cur_index % group_type::width])->value();
+        }
+        pointer operator->() const {
+            return **this;
+        }
+
+        // prefix ++
+        compact_hash_map_iterator& operator++() {
+            cur_index++;
+            seek_helper();
+            return *this;
+        }
+        // postfix ++
+        compact_hash_map_iterator operator++(int) {
+            compact_hash_map_iterator old = *this;
+            ++(*this);
+            return old;
+        }
+
+        friend bool operator==(const compact_hash_map_iterator& l_point, const compact_hash_map_iterator& r_point) {
+            return l_point.groups == r_point.groups && l_point.cur_index == r_point.cur_index;
+        }
+        friend bool operator!=(const compact_hash_map_iterator& l_point, const compact_hash_map_iterator& r_point) {
+            return !(l_point == r_point);
+        }
+
+    private:
+        template<typename, typename>
+        friend class compact_hash_map_iterator;
+        template<typename, typename, class, class, typename, typename>
+        friend class compact_hash_map;
+
+        // Moves to the first element at or after cur_index, a group at a time.
+        void seek_helper() noexcept {
+            while (cur_index < size) {
+                size_t lane = cur_index % group_type::width;
+                std::uint64_t mask = groups[cur_index / group_type::width].occupied() >> (2 * lane);
+                if (mask) {
+                    cur_index += group_type::first_lane(mask);
+                    return;
+                }
+                cur_index += group_type::width - lane;
+            }
+            cur_index = size;
+        }
+
+        const group_type* groups;
+        const Arena* arena;
+        size_t cur_index;
+        size_t size;
+    };
+
+
+    /**
+     *  %hash_map variant whose table holds 32-bit node indices instead of
+     *  node pointers. Nodes live in a %hash_map_node_arena owned by the
+     *  map, which caps it at 2^32 - 1 elements. A slot group line then
+     *  carries 14 slots instead of 7, and the table takes half the memory.
+     *
+     *  Indices leave no room for fingerprints, so a probe checks the
+     *  cached hashes of the occupied lanes of a group, which costs one node
+     *  access per lane. Elements never move: references stay valid until
+     *  the element is erased.
+     */
+    template<typename K, typename T,
+            class FirstHash = FirstKeyHash<K>,
+            class SecondHash = SecondKeyHash<K>,
+            typename Pred = std::equal_to<K>,
+            typename Alloc = allocator<std::pair<const K, T>*>>
+    class compact_hash_map : public hash_map_container_base<compact_hash_map<K, T, FirstHash, SecondHash, Pred, Alloc>, K, T>
+    {
+    public:
+        using key_type = K;
+        using mapped_type = T;
+        using allocator_type = Alloc;
+        using value_type = std::pair<const key_type, mapped_type>;
+        using size_type = std::size_t;
+
+    private:
+        using hash_node = hash_map_node<value_type>;
+        using node_arena = hash_map_node_arena<hash_node, allocator_type>;
+        using index_type = typename node_arena::index_type;
+
+        friend class hash_map_container_base<compact_hash_map, K, T>;
+
+        void swap_helper(compact_hash_map& x, bool allocators) {
+            std::swap(SIZE, x.SIZE);
+            std::swap(NOT_NULL_SIZE, x.NOT_NULL_SIZE);
+            std::swap(DELETED_SIZE, x.DELETED_SIZE);
+            std::swap(LOAD_FACTOR, x.LOAD_FACTOR);
+            std::swap(table, x.table);
+            std::swap(table_memory, x.table_memory);
+            std::swap(firstHash, x.firstHash);
+            std::swap(secondHash, x.secondHash);
+            std::swap(key_equal, x.key_equal);
+            if(allocators)
+                std::swap(table_allocator, x.table_allocator);
+            nodes.swap(x.nodes, allocators);
+        }
+
+    public:
+        using iterator = compact_hash_map_iterator<value_type, node_arena>;
+        using const_iterator = compact_hash_map_iterator<const value_type, node_arena>;
+
+    private:
+        using alloc_traits = std::allocator_traits<allocator_type>;
+        using value_alloc_traits = std::allocator_traits<typename node_arena::allocator_type>;
+        using slot_group = typename iterator::group_type;
+        using table_allocator_type = typename alloc_traits::template rebind_alloc<slot_group>;
+        using table_alloc_traits = std::allocator_traits<table_allocator_type>;
+
+        // Size of the first table, allocated by the first insert.
+        static constexpr size_type INITIAL_SIZE = 37;
+
+        size_type SIZE = 0;
+        size_type NOT_NULL_SIZE = 0;
+        size_type DELETED_SIZE = 0;
+        float LOAD_FACTOR = 0.7;
+        // table is table_memory rounded up to a cache line.
+        slot_group *table = nullptr;
+        slot_group *table_memory = nullptr;
+        FirstHash firstHash;
+        SecondHash secondHash;
+        Pred key_equal;
+        table_allocator_type table_allocator{allocator_type()};
+        node_arena nodes{typename node_arena::allocator_type(table_allocator)};
+
+        index_type& slot_helper(size_type x) noexcept {
+            return table[x / slot_group::width].slots[x % slot_group::width];
+        }
+
+        index_type slot_helper(size_type x) const noexcept {
+            return table[x / slot_group::width].slots[x % slot_group::width];
+        }
+
+        slot_state state_helper(size_type x) const noexcept {
+            return table[x / slot_group::width].state(x % slot_group::width);
+        }
+
+        void set_state_helper(size_type x, slot_state state) noexcept {
+            table[x / slot_group::width].set_state(x % slot_group::width, state);
+        }
+
+        // The slot count is rounded up to whole groups.
+        void allocate_table_helper(size_type n) {
+            size_type size = (n + slot_group::width - 1) / slot_group::width * slot_group::width;
+            if(size < 2 * slot_group::width)
+                size = 2 * slot_group::width;
+            table_memory = table_alloc_traits::allocate(table_allocator, size / slot_group::width + 1);
+            std::uintptr_t address = reinterpret_cast<std::uintptr_t>(table_memory);
+            std::uintptr_t line = slot_group::line_size;
+            table = reinterpret_cast<slot_group*>((address + line - 1) / line * line);
+            SIZE = size;
+            for(size_type g = 0; g < SIZE / slot_group::width; g++)
+                table[g].states = 0;
+        }
+
+        void deallocate_table_helper(slot_group* old_memory, size_type n) {
+            if(old_memory != nullptr)
+                table_alloc_traits::deallocate(table_allocator, old_memory, n / slot_group::width + 1);
+        }
+
+        template<typename F>
+        static void for_each_element_helper(const slot_group* groups, size_type n, F f) {
+            for(size_type g = 0; g < n / slot_group::width; g++) {
+                for(std::uint64_t mask = groups[g].occupied(); mask; mask &= mask - 1)
+                    f(g * slot_group::width + slot_group::first_lane(mask));
+            }
+        }
+
+        template<typename... Args>
+        index_type create_node_helper(Args&&... args) {
+            index_type i = nodes.allocate();
+            try {
+                typename node_arena::allocator_type a = nodes.get_allocator();
+                value_alloc_traits::construct(a, nodes.node(i)->value(), std::forward<Args>(args)...);
+            } catch(...) {
+                nodes.deallocate(i);
+                throw;
+            }
+            return i;
+        }
+
+        void destroy_node_helper(index_type i) {
+            typename node_arena::allocator_type a = nodes.get_allocator();
+            value_alloc_traits::destroy(a, nodes.node(i)->value());
+            nodes.deallocate(i);
+        }
+
+        void destroy_elements_helper() {
+            if(!std::is_trivially_destructible<value_type>::value) {
+                typename node_arena::allocator_type a = nodes.get_allocator();
+                for_each_element_helper(table, SIZE, [this, &a](size_type x) {
+                    value_alloc_traits::destroy(a, nodes.node(slot_helper(x))->value());
+                });
+            }
+            nodes.release();
+        }
+
+        void release_table_helper() noexcept {
+            deallocate_table_helper(table_memory, SIZE);
+            table = nullptr;
+            table_memory = nullptr;
+            SIZE = 0;
+            NOT_NULL_SIZE = 0;
+            DELETED_SIZE = 0;
+        }
+
+        iterator make_iterator(size_type x) {
+            return iterator(table, &nodes, x, SIZE);
+        }
+
+        const_iterator make_iterator(size_type x) const {
+            return const_iterator(table, &nodes, x, SIZE);
+        }
+
+        void check_load_factor() {
+            if(SIZE == 0)
+                return;
+            if((float)(NOT_NULL_SIZE + DELETED_SIZE) / (float)SIZE >= LOAD_FACTOR) {
+                if((float)NOT_NULL_SIZE / (float)SIZE < LOAD_FACTOR / 2)
+                    rehash(SIZE);
+                else
+                    rehash(2 * SIZE);
+            }
+        }
+
+        size_type group_count_helper() const noexcept {
+            return SIZE / slot_group::width;
+        }
+
+        // Group probing as in %hash_map, along the default probe policy.
+        // Returns the slot holding key and true, or the first reusable slot
+        // and false; SIZE means the probe sequence has no free slot.
+        std::pair<size_type, bool> find_position_helper(const key_type& key, const hash_map_key_hash& h) const {
+            if (SIZE == 0)
+                return {SIZE, false};
+            size_type groups = group_count_helper();
+            double_hash_probe::sequence probe(h, groups);
+            size_type free_slot = SIZE;
+            for (size_type i = 0; i < groups; i++, probe.next()) {
+                size_type g = probe.group();
+                const slot_group& group = table[g];
+                for (std::uint64_t mask = group.occupied(); mask; mask &= mask - 1) {
+                    size_type lane = slot_group::first_lane(mask);
+                    const hash_node* node = nodes.node(group.slots[lane]);
+                    if (node->hash.first == h.first && node->hash.second == h.second
+                        && key_equal(node->value()->first, key))
+                        return {g * slot_group::width + lane, true};
+                }
+                std::uint64_t deleted = group.match(slot_state::deleted);
+                if (deleted && free_slot == SIZE)
+                    free_slot = g * slot_group::width + slot_group::first_lane(deleted);
+                std::uint64_t empty = group.match(slot_state::empty);
+                if (empty)
+                    return {free_slot == SIZE ? g * slot_group::width + slot_group::first_lane(empty) : free_slot, false};
+            }
+            return {free_slot, false};
+        }
+
+        std::pair<size_type, bool> find_position_helper(const key_type& key) const {
+            return find_position_helper(key, hash_key(firstHash, secondHash, key));
+        }
+
+        size_type find_free_slot_helper(const hash_map_key_hash& h) const {
+            size_type groups = group_count_helper();
+            double_hash_probe::sequence probe(h, groups);
+            for (size_type i = 0; i < groups; i++, probe.next()) {
+                std::uint64_t available = table[probe.group()].available();
+                if (available)
+                    return probe.group() * slot_group::width + slot_group::first_lane(available);
+            }
+            return SIZE;
+        }
+
+        std::pair<size_type, bool> find_insert_position_helper(const key_type& key, const hash_map_key_hash& h) {
+            auto pos = find_position_helper(key, h);
+            while (!pos.second && pos.first == SIZE) {
+                rehash(SIZE == 0 ? INITIAL_SIZE : 2 * SIZE);
+                pos = find_position_helper(key, h);
+            }
+            return pos;
+        }
+
+        void place_node_helper(size_type x, index_type i) {
+            if(state_helper(x) == slot_state::deleted)
+                DELETED_SIZE--;
+            slot_helper(x) = i;
+            set_state_helper(x, slot_state::full);
+            NOT_NULL_SIZE++;
+        }
+
+        void erase_slot_helper(size_type x) {
+            destroy_node_helper(slot_helper(x));
+            set_state_helper(x, slot_state::deleted);
+            NOT_NULL_SIZE--;
+            DELETED_SIZE++;
+        }
+
+        template<typename Key, typename... Args>
+        std::pair<iterator, bool> try_emplace_helper(Key&& key, Args&&... args) {
+            check_load_factor();
+            hash_map_key_hash h = hash_key(firstHash, secondHash, key);
+            auto pos = find_insert_position_helper(key, h);
+            if (pos.second)
+                return {make_iterator(pos.first), false};
+            index_type i = create_node_helper(std::piecewise_construct,
+                                              std::forward_as_tuple(std::forward<Key>(key)),
+                                              std::forward_as_tuple(std::forward<Args>(args)...));
+            nodes.node(i)->hash = h;
+            place_node_helper(pos.first, i);
+            return {make_iterator(pos.first), true};
+        }
+
+    public:
+        /// Default constructor. The first insert allocates the table.
+        compact_hash_map() {}
+
+        /**
+         *  @brief  Default constructor creates no elements.
+         *  @param n  Minimal initial number of buckets.
+         */
+        explicit compact_hash_map(size_type n) {
+            if(n > 0)
+                rehash(n);
+        }
+
+        explicit compact_hash_map(const allocator_type& a)
+        : table_allocator(a), nodes(typename node_arena::allocator_type(a)) {}
+
+        /// Copy constructor. Elements are inserted again, so the copy has
+        /// no tombstones and a compact arena.
+        compact_hash_map(const compact_hash_map& other)
+        : compact_hash_map(other, alloc_traits::select_on_container_copy_construction(other.get_allocator())) {}
+
+        /// Copy constructor with allocator argument.
+        compact_hash_map(const compact_hash_map& other, const allocator_type& a)
+        : LOAD_FACTOR(other.LOAD_FACTOR), firstHash(other.firstHash), secondHash(other.secondHash),
+          key_equal(other.key_equal), table_allocator(a), nodes(typename node_arena::allocator_type(a)) {
+            try {
+                if(other.NOT_NULL_SIZE != 0)
+                    rehash(other.SIZE);
+                for_each_element_helper(other.table, other.SIZE, [this, &other](size_type x) {
+                    const hash_node* node = other.nodes.node(other.slot_helper(x));
+                    index_type i = create_node_helper(*node->value());
+                    nodes.node(i)->hash = node->hash;
+                    place_node_helper(find_free_slot_helper(node->hash), i);
+                });
+            } catch(...) {
+                destroy_elements_helper();
+                release_table_helper();
+                throw;
+            }
+        }
+
+        /// Move constructor.
+        compact_hash_map(compact_hash_map&& other)
+        : SIZE(other.SIZE), NOT_NULL_SIZE(other.NOT_NULL_SIZE), DELETED_SIZE(other.DELETED_SIZE),
+          LOAD_FACTOR(other.LOAD_FACTOR), table(other.table), table_memory(other.table_memory),
+          firstHash(std::move(other.firstHash)), secondHash(std::move(other.secondHash)),
+          key_equal(std::move(other.key_equal)), table_allocator(std::move(other.table_allocator)),
+          nodes(std::move(other.nodes)) {
+            other.table = nullptr;
+            other.table_memory = nullptr;
+            other.SIZE = 0;
+            other.NOT_NULL_SIZE = 0;
+            other.DELETED_SIZE = 0;
+        }
+
+        /**
+         *  @brief  Move constructor with allocator argument.
+         *
+         *  The memory of @a other is adopted only if its allocator compares
+         *  equal to @a a; otherwise its elements are moved one by one.
+         */
+        compact_hash_map(compact_hash_map&& other, const allocator_type& a)
+        : LOAD_FACTOR(other.LOAD_FACTOR), firstHash(other.firstHash), secondHash(other.secondHash),
+          key_equal(other.key_equal), table_allocator(a), nodes(typename node_arena::allocator_type(a)) {
+            this->move_construct_helper(other);
+        }
+
+        /// Builds a %compact_hash_map from an initializer_list.
+        compact_hash_map(std::initializer_list<value_type> l) {
+            this->insert(l);
+        }
+
+        ~compact_hash_map() {
+            destroy_elements_helper();
+            deallocate_table_helper(table_memory, SIZE);
+        }
+
+        /// Copy assignment operator.
+        compact_hash_map& operator=(const compact_hash_map& other) {
+            return this->copy_assign_helper(other);
+        }
+
+        /// Move assignment operator.
+        compact_hash_map& operator=(compact_hash_map&& other) {
+            return this->move_assign_helper(std::move(other));
+        }
+
+        ///  Returns the allocator object used by the %compact_hash_map.
+        allocator_type get_allocator() const noexcept {
+            return allocator_type(table_allocator);
+        }
+
+        ///  Returns the size of the %compact_hash_map.
+        size_type size() const noexcept {
+            return NOT_NULL_SIZE;
+        }
+
+        ///  Returns the number of slots of the %compact_hash_map.
+        size_type max_size() const noexcept {
+            return SIZE;
+        }
+
+        iterator begin() noexcept {
+            iterator it = make_iterator(0);
+            it.seek_helper();
+            return it;
+        }
+
+        const_iterator begin() const noexcept {
+            const_iterator it = make_iterator(0);
+            it.seek_helper();
+            return it;
+        }
+
+        iterator end() noexcept {
+            return make_iterator(SIZE);
+        }
+
+        const_iterator end() const noexcept {
+            return make_iterator(SIZE);
+        }
+
+        /**
+         *  @brief Erases elements according to the provided key.
+         *  @param  key  Key of element to be erased.
+         *  @return  The number of elements erased.
+         */
+        size_type erase(const key_type& key) {
+            auto pos = find_position_helper(key);
+            if (!pos.second)
+                return 0;
+            erase_slot_helper(pos.first);
+            return 1;
+        }
+
+        /**
+         *  @brief Erases an element from a %compact_hash_map.
+         *  @param  position  An iterator pointing to the element to be erased.
+         *  @return An iterator pointing to the next element.
+         */
+        iterator erase(const_iterator position) {
+            size_type x = position.cur_index;
+            erase_slot_helper(x);
+            iterator next = make_iterator(x);
+            ++next;
+            return next;
+        }
+
+        /// Erases all elements and releases the table and the arena.
+        void clear() noexcept {
+            destroy_elements_helper();
+            release_table_helper();
+        }
+
+        //@{
+        /**
+         *  @brief Tries to locate an element in a %compact_hash_map.
+         *  @param  key  Key to be located.
+         *  @return  Iterator pointing to sought-after element, or end() if not
+         *           found.
+         */
+        iterator find(const key_type& key) {
+            auto pos = find_position_helper(key);
+            return make_iterator(pos.second ? pos.first : SIZE);
+        }
+
+        const_iterator find(const key_type& key) const {
+            auto pos = find_position_helper(key);
+            return make_iterator(pos.second ? pos.first : SIZE);
+        }
+        //@}
+
+        /// Returns the average number of elements per slot.
+        float load_factor() const noexcept {
+            return SIZE == 0 ? 0 : (float)NOT_NULL_SIZE / (float)SIZE;
+        }
+
+        /// Returns the load factor the %compact_hash_map keeps below.
+        float max_load_factor() const noexcept {
+            return LOAD_FACTOR;
+        }
+
+        /// Changes the maximum load factor. z must lie in (0, 1).
+        void max_load_factor(float z) {
+            LOAD_FACTOR = z;
+            check_load_factor();
+        }
+
+        /**
+         *  @brief  Returns the bytes held by the %compact_hash_map.
+         *
+         *  Accounted as for %hash_map, with 32-bit slots. Arena nodes that
+         *  hold no element count as nodes and as slack.
+         */
+        hash_map_memory_usage memory_usage() const noexcept {
+            hash_map_memory_usage usage;
+            usage.table = SIZE * sizeof(index_type);
+            usage.metadata = SIZE / slot_group::width * sizeof(slot_group) - usage.table;
+            usage.nodes = nodes.capacity_bytes();
+            usage.tombstones = DELETED_SIZE * sizeof(index_type);
+            usage.slack = (SIZE - NOT_NULL_SIZE) * sizeof(index_type)
+                          + usage.nodes - NOT_NULL_SIZE * sizeof(hash_node);
+            usage.backing = table_backing::allocator;
+            if(table_memory) {
+                usage.slack += sizeof(slot_group);
+                usage.metadata += sizeof(slot_group);
+            }
+            return usage;
+        }
+
+        /**
+         *  @brief  Rebuilds the table with at least @a n slots.
+         *
+         *  Only indices are relinked; nodes stay where they are and their
+         *  cached hashes spare the hash functors.
+         */
+        void rehash(size_type n) {
+            if(n <= NOT_NULL_SIZE)
+                n = NOT_NULL_SIZE + 1;
+            size_type PAST_SIZE = SIZE;
+            slot_group *past_table = table;
+            slot_group *past_memory = table_memory;
+
+            for(;;) {
+                allocate_table_helper(n);
+                NOT_NULL_SIZE = 0;
+                DELETED_SIZE = 0;
+
+                bool relinked = true;
+                for_each_element_helper(past_table, PAST_SIZE, [this, past_table, &relinked](size_type i) {
+                    if(!relinked)
+                        return;
+                    index_type node = past_table[i / slot_group::width].slots[i % slot_group::width];
+                    size_type x = find_free_slot_helper(nodes.node(node)->hash);
+                    if(x == SIZE)
+                        relinked = false;
+                    else
+                        place_node_helper(x, node);
+                });
+                if(relinked)
+                    break;
+
+                deallocate_table_helper(table_memory, SIZE);
+                n = 2 * n;
+            }
+
+            deallocate_table_helper(past_memory, PAST_SIZE);
+        }
+
+        /// Prepares the %compact_hash_map for @a n elements.
+        void reserve(size_type n) {
+            rehash(ceil((float)n / (float)max_load_factor()));
+        }
+    };
+
+} // namespace fefu
+
+
+
+#endif //HASHMAP_COMPACT_HASH_MAP_H
@@ -0,0 +1,460 @@
+#ifndef HASHMAP_DIRECT_HASH_MAP_H
+#define HASHMAP_DIRECT_HASH_MAP_H
+
+
+#pragma once
+
+#include "hash_map.h"
+
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+namespace fefu
+{
+
+    /**
+     *  Iterator of a %direct_hash_map. Keys are not stored: the key of
+     *  index i is min_key + i, and a presence bitmap tells which indices
+     *  hold a value.
+     */
+    template<typename K, typename T>
+    class direct_hash_map_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<const K, typename std::remove_const<T>::type>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::pair<const K, T&>;
+
+        // Keeps the pair alive for operator->.
+        struct pointer {
+            reference ref;
+            reference* operator->() noexcept {
+                return &ref;
+            }
+        };
+
+        direct_hash_map_iterator() noexcept {}
+
+        direct_hash_map_iterator(T* values, const std::uint64_t* present, K min_key,
+                                 size_t cur_index, size_t size) noexcept
+        : values(values), present(present), min_key(min_key), cur_index(cur_index), size(size) {}
+
+        template<typename U, typename = typename std::enable_if<std::is_same<const U, T>::value>::type>
+        direct_hash_map_iterator(const direct_hash_map_iterator<K, U>& other) noexcept
+        : values(other.values), present(other.present), min_key(other.min_key),
+          cur_index(other.cur_index), size(other.size) {}
+
+        reference operator*() const {
+            return {static_cast<K>(min_key + cur_index), values[cur_index]};
+        }
+        pointer operator->() const {
+            return {**this};
+        }
+
+        // prefix ++
+        direct_hash_map_iterator& operator++() {
+            cur_index++;
+            seek_helper();
+            return *this;
+        }
+        // postfix ++
+        direct_hash_map_iterator operator++(int) {
+            direct_hash_map_iterator old = *this;
+            ++(*this);
+            return old;
+        }
+
+        friend bool operator==(const direct_hash_map_iterator& l_point, const direct_hash_map_iterator& r_point) {
+            return l_point.values == r_point.values && l_point.cur_index == r_point.cur_index;
+        }
+        friend bool operator!=(const direct_hash_map_iterator& l_point, const direct_hash_map_iterator& r_point) {
+            return !(l_point == r_point);
+        }
+
+    private:
+        template<typename, typename>
+        friend class direct_hash_map_iterator;
+        template<typename, typename, typename>
+        friend class direct_hash_map;
+
+        // Skips absent indices a bitmap word at a time.
+        void seek_helper() noexcept {
+            while (cur_index < size) {
+                std::uint64_t word = present[cur_index / 64] >> (cur_index % 64);
+                if (word != 0) {
+                    cur_index += lowest_bit(word);
+                    if (cur_index > size)
+                        cur_index = size;
+                    return;
+                }
+                cur_index = (cur_index / 64 + 1) * 64;
+            }
+            cur_index = size;
+        }
+
+        T* values;
+        const std::uint64_t* present;
+        K min_key;
+        size_t cur_index;
+        size_t size;
+    };
+
+
+    /**
+     *  Direct-addressed map for integral keys of a bounded range, such as
+     *  dense ids 0..N. The value of key k lives at index k - min_key of a
+     *  value array, and a presence bitmap marks which indices are set, so
+     *  a lookup is one bitmap test and one indexed load with no hashing or
+     *  probing. Keys themselves are not stored.
+     *
+     *  The range is fixed at construction and both arrays cover all of it,
+     *  allocated by the first insert. That pays off when most keys of the
+     *  range are present; sparse key sets belong in %integer_hash_map.
+     *  Values never move, so references stay valid until their element is
+     *  erased.
+     *
+     *  Inserting a key outside the range, through try_emplace(), emplace(),
+     *  insert(), insert_or_assign() or operator[], throws
+     *  std::out_of_range. swap() exchanges the ranges too.
+     *
+     *  The interface is that of hash_map_container_base plus the lookups,
+     *  erase() and clear(), not all of %hash_map: the iterators hand out
+     *  proxy pairs of the key and a reference to the value, so it->second
+     *  works but no pair pointer can be kept, and there is no merge(),
+     *  extract() or node handle, nor rehash() or load factor.
+     */
+    template<typename K, typename T,
+            typename Alloc = allocator<std::pair<const K, T>*>>
+    class direct_hash_map : public hash_map_container_base<direct_hash_map<K, T, Alloc>, K, T>
+    {
+        static_assert(std::is_integral<K>::value, "direct_hash_map needs an integral key type");
+
+    public:
+        using key_type = K;
+        using mapped_type = T;
+        using allocator_type = Alloc;
+        using value_type = std::pair<const key_type, mapped_type>;
+        using iterator = direct_hash_map_iterator<key_type, mapped_type>;
+        using const_iterator = direct_hash_map_iterator<key_type, const mapped_type>;
+        using size_type = std::size_t;
+
+    private:
+        // Alloc is rebound for the value array and the presence bitmap.
+        using alloc_traits = std::allocator_traits<allocator_type>;
+        using value_allocator_type = typename alloc_traits::template rebind_alloc<mapped_type>;
+        using word_allocator_type = typename alloc_traits::template rebind_alloc<std::uint64_t>;
+        using value_alloc_traits = std::allocator_traits<value_allocator_type>;
+        using word_alloc_traits = std::allocator_traits<word_allocator_type>;
+        using unsigned_key = typename std::make_unsigned<key_type>::type;
+
+        key_type MIN_KEY = 0;
+        size_type SIZE = 0;
+        size_type NOT_NULL_SIZE = 0;
+        mapped_type* values = nullptr;
+        std::uint64_t* present = nullptr;
+        value_allocator_type value_allocator{allocator_type()};
+        word_allocator_type word_allocator{value_allocator};
+
+        size_type word_count_helper() const noexcept {
+            return (SIZE + 63) / 64;
+        }
+
+        // Returns the index of key, or SIZE for keys outside the range.
+        size_type index_helper(const key_type& key) const noexcept {
+            if (key < MIN_KEY)
+                return SIZE;
+            // Narrow keys promote to int, so the difference is cut back to
+            // unsigned_key before it widens.
+            unsigned_key offset = static_cast<unsigned_key>(static_cast<unsigned_key>(key) - static_cast<unsigned_key>(MIN_KEY));
+            size_type x = static_cast<size_type>(offset);
+            return x < SIZE ? x : SIZE;
+        }
+
+        bool present_helper(size_type x) const noexcept {
+            return present != nullptr && (present[x / 64] >> (x % 64) & 1);
+        }
+
+        // Allocates the value array and a cleared bitmap for the whole range.
+        // Values are constructed as keys are inserted.
+        void allocate_arrays_helper() {
+            std::uint64_t* new_present = word_alloc_traits::allocate(word_allocator, word_count_helper());
+            try {
+                values = value_alloc_traits::allocate(value_allocator, SIZE);
+            } catch(...) {
+                word_alloc_traits::deallocate(word_allocator, new_present, word_count_helper());
+                throw;
+            }
+            present = new_present;
+            std::fill(present, present + word_count_helper(), 0);
+        }
+
+        void destroy_elements_helper() noexcept {
+            for(size_type x = 0; x < SIZE; x++) {
+                if(present_helper(x))
+                    value_alloc_traits::destroy(value_allocator, values + x);
+            }
+        }
+
+        void release_helper() noexcept {
+            if(present == nullptr)
+                return;
+            destroy_elements_helper();
+            value_alloc_traits::deallocate(value_allocator, values, SIZE);
+            word_alloc_traits::deallocate(word_allocator, present, word_count_helper());
+            values = nullptr;
+            present = nullptr;
+            NOT_NULL_SIZE = 0;
+        }
+
+        // Clones the values of other index by index and copies its bitmap.
+        void copy_elements_helper(const direct_hash_map& other) {
+            if(other.present == nullptr)
+                return;
+            allocate_arrays_helper();
+            size_type x = 0;
+            try {
+                for(; x < SIZE; x++) {
+                    if(other.present_helper(x))
+                        value_alloc_traits::construct(value_allocator, values + x, other.values[x]);
+                }
+            } catch(...) {
+                for(size_type y = 0; y < x; y++) {
+                    if(other.present_helper(y))
+                        value_alloc_traits::destroy(value_allocator, values + y);
+                }
+                value_alloc_traits::deallocate(value_allocator, values, SIZE);
+                word_alloc_traits::deallocate(word_allocator, present, word_count_helper());
+                values = nullptr;
+                present = nullptr;
+                throw;
+            }
+            std::copy(other.present, other.present + word_count_helper(), present);
+            NOT_NULL_SIZE = other.NOT_NULL_SIZE;
+        }
+
+        iterator make_iterator(size_type x) {
+            return iterator(values, present, MIN_KEY, x, present == nullptr ? 0 : SIZE);
+        }
+
+        const_iterator make_iterator(size_type x) const {
+            return const_iterator(values, present, MIN_KEY, x, present == nullptr ? 0 : SIZE);
+        }
+
+        template<typename... _Args>
+        std::pair<iterator, bool> try_emplace_helper(const key_type& k, _Args&&... args) {
+            size_type x = index_helper(k);
+            if (x == SIZE)
+                throw std::out_of_range("key outside the direct_hash_map range");
+            if (present == nullptr)
+                allocate_arrays_helper();
+            if (present_helper(x))
+                return {make_iterator(x), false};
+            value_alloc_traits::construct(value_allocator, values + x, std::forward<_Args>(args)...);
+            present[x / 64] |= std::uint64_t(1) << (x % 64);
+            NOT_NULL_SIZE++;
+            return {make_iterator(x), true};
+        }
+
+        void erase_index_helper(size_type x) {
+            value_alloc_traits::destroy(value_allocator, values + x);
+            present[x / 64] &= ~(std::uint64_t(1) << (x % 64));
+            NOT_NULL_SIZE--;
+        }
+
+        friend class hash_map_container_base<direct_hash_map, K, T>;
+
+        void swap_helper(direct_hash_map& x, bool allocators) {
+            std::swap(MIN_KEY, x.MIN_KEY);
+            std::swap(SIZE, x.SIZE);
+            std::swap(NOT_NULL_SIZE, x.NOT_NULL_SIZE);
+            std::swap(values, x.values);
+            std::swap(present, x.present);
+            if(allocators) {
+                std::swap(value_allocator, x.value_allocator);
+                std::swap(word_allocator, x.word_allocator);
+            }
+        }
+
+    public:
+        /**
+         *  @brief  Creates a map for the keys [min_key, max_key].
+         *  @throw  std::invalid_argument  If max_key is below min_key.
+         *  @throw  std::length_error  If the range has more keys than
+         *          size_type can count.
+         */
+        direct_hash_map(key_type min_key, key_type max_key, const allocator_type& a = allocator_type())
+        : MIN_KEY(min_key), value_allocator(a), word_allocator(a) {
+            if(max_key < min_key)
+                throw std::invalid_argument("max_key is below min_key");
+            unsigned_key span = static_cast<unsigned_key>(max_key) - static_cast<unsigned_key>(min_key);
+            if(span >= std::numeric_limits<size_type>::max())
+                throw std::length_error("direct_hash_map range is too large");
+            SIZE = static_cast<size_type>(span) + 1;
+        }
+
+        /// Copy constructor.
+        direct_hash_map(const direct_hash_map& other)
+        : direct_hash_map(other, alloc_traits::select_on_container_copy_construction(other.get_allocator())) {}
+
+        /// Copy constructor with allocator argument.
+        direct_hash_map(const direct_hash_map& other, const allocator_type& a)
+        : MIN_KEY(other.MIN_KEY), SIZE(other.SIZE), value_allocator(a), word_allocator(a) {
+            copy_elements_helper(other);
+        }
+
+        /// Move constructor. other keeps its range and is left empty.
+        direct_hash_map(direct_hash_map&& other)
+        : MIN_KEY(other.MIN_KEY), SIZE(other.SIZE), NOT_NULL_SIZE(other.NOT_NULL_SIZE),
+          values(other.values), present(other.present),
+          value_allocator(std::move(other.value_allocator)), word_allocator(std::move(other.word_allocator)) {
+            other.values = nullptr;
+            other.present = nullptr;
+            other.NOT_NULL_SIZE = 0;
+        }
+
+        /**
+         *  @brief  Move constructor with allocator argument.
+         *
+         *  The memory of @a other is adopted only if its allocator compares
+         *  equal to @a a; otherwise its elements are moved one by one.
+         */
+        direct_hash_map(direct_hash_map&& other, const allocator_type& a)
+        : MIN_KEY(other.MIN_KEY), SIZE(other.SIZE), value_allocator(a), word_allocator(a) {
+            this->move_construct_helper(other);
+        }
+
+        ~direct_hash_map() {
+            release_helper();
+        }
+
+        /// Copy assignment operator.
+        direct_hash_map& operator=(const direct_hash_map& other) {
+            return this->copy_assign_helper(other);
+        }
+
+        /// Move assignment operator.
+        direct_hash_map& operator=(direct_hash_map&& other) {
+            return this->move_assign_helper(std::move(other));
+        }
+
+        ///  Returns the allocator object used by the %direct_hash_map.
+        allocator_type get_allocator() const noexcept {
+            return allocator_type(value_allocator);
+        }
+
+        ///  Returns the size of the %direct_hash_map.
+        size_type size() const noexcept {
+            return NOT_NULL_SIZE;
+        }
+
+        ///  Returns the number of keys in the range of the %direct_hash_map.
+        size_type max_size() const noexcept {
+            return SIZE;
+        }
+
+        /// Returns the smallest key the %direct_hash_map accepts.
+        key_type min_key() const noexcept {
+            return MIN_KEY;
+        }
+
+        /// Returns the largest key the %direct_hash_map accepts.
+        key_type max_key() const noexcept {
+            return static_cast<key_type>(static_cast<unsigned_key>(MIN_KEY) + static_cast<unsigned_key>(SIZE - 1));
+        }
+
+        iterator begin() noexcept {
+            iterator it = make_iterator(0);
+            it.seek_helper();
+            return it;
+        }
+
+        const_iterator begin() const noexcept {
+            const_iterator it = make_iterator(0);
+            it.seek_helper();
+            return it;
+        }
+
+        iterator end() noexcept {
+            return make_iterator(present == nullptr ? 0 : SIZE);
+        }
+
+        const_iterator end() const noexcept {
+            return make_iterator(present == nullptr ? 0 : SIZE);
+        }
+
+        /**
+         *  @brief Erases elements according to the provided key.
+         *  @param  key  Key of element to be erased.
+         *  @return  The number of elements erased.
+         */
+        size_type erase(const key_type& key) {
+            size_type x = index_helper(key);
+            if (x == SIZE || !present_helper(x))
+                return 0;
+            erase_index_helper(x);
+            return 1;
+        }
+
+        /**
+         *  @brief Erases an element from a %direct_hash_map.
+         *  @param  position  An iterator pointing to the element to be erased.
+         *  @return  An iterator pointing to the next element.
+         */
+        iterator erase(const_iterator position) {
+            erase_index_helper(position.cur_index);
+            iterator next = make_iterator(position.cur_index + 1);
+            next.seek_helper();
+            return next;
+        }
+
+        /// Erases all elements and releases both arrays. The range is kept.
+        void clear() noexcept {
+            release_helper();
+        }
+
+        //@{
+        /**
+         *  @brief Tries to locate an element in a %direct_hash_map.
+         *  @param  key  Key to be located.
+         *  @return  Iterator pointing to sought-after element, or end() if not
+         *           found.
+         */
+        iterator find(const key_type& key) {
+            size_type x = index_helper(key);
+            return x != SIZE && present_helper(x) ? make_iterator(x) : end();
+        }
+
+        const_iterator find(const key_type& key) const {
+            size_type x = index_helper(key);
+            return x != SIZE && present_helper(x) ? make_iterator(x) : end();
+        }
+        //@}
+
+        /// Returns the share of keys of the range that are present.
+        float load_factor() const noexcept {
+            return (float)NOT_NULL_SIZE / (float)SIZE;
+        }
+
+        /**
+         *  @brief  Returns the bytes held by the %direct_hash_map.
+         *
+         *  The value array counts as table and the bitmap as metadata. There
+         *  are no nodes; absent keys are slack.
+         */
+        hash_map_memory_usage memory_usage() const noexcept {
+            hash_map_memory_usage usage{0, 0, 0, 0, 0, table_backing::allocator};
+            if(present == nullptr)
+                return usage;
+            usage.table = SIZE * sizeof(mapped_type);
+            usage.metadata = word_count_helper() * sizeof(std::uint64_t);
+            usage.slack = (SIZE - NOT_NULL_SIZE) * sizeof(mapped_type);
+            return usage;
+        }
+    };
+
+} // namespace fefu
+
+
+
+#endif //HASHMAP_DIRECT_HASH_MAP_H
@@ -0,0 +1,652 @@
+#ifndef HASHMAP_EXTENDIBLE_HASH_MAP_H
+#define HASHMAP_EXTENDIBLE_HASH_MAP_H
+
+
+#pragma once
+
+#include "hash_map.h"
+
+#include <iterator>
+#include <stdexcept>
+
+namespace fefu
+{
+
+    /**
+     *  Fixed-size table of an %extendible_hash_map. The segment serves the
+     *  directory entries whose low local_depth bits match, and its slots
+     *  are probed linearly with wrap-around. Erasing shifts the rest of the
+     *  cluster back, so a segment never holds tombstones.
+     */
+    template<typename Node, std::size_t Size>
+    struct extendible_hash_map_segment {
+        static constexpr std::size_t width = Size;
+
+        std::size_t local_depth;
+        std::size_t count;
+        Node* slots[Size];
+    };
+
+    template<typename Node, std::size_t Size>
+    constexpr std::size_t extendible_hash_map_segment<Node, Size>::width;
+
+
+    /**
+     *  Iterator of an %extendible_hash_map. Walks the directory, visiting
+     *  each segment once at the lowest directory entry pointing to it, and
+     *  hands out element pointers like the %hash_map iterators.
+     */
+    template<typename ValueType, typename Segment>
+    class extendible_hash_map_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ValueType;
+        using difference_type = std::ptrdiff_t;
+        using reference = ValueType*;
+        using pointer = ValueType*;
+
+        extendible_hash_map_iterator() noexcept {}
+
+        extendible_hash_map_iterator(Segment* const* directory, size_t entry, size_t slot, size_t entries) noexcept
+        : directory(directory), entry(entry), slot(slot), entries(entries) {}
+
+        template<typename U, typename = typename std::enable_if<std::is_same<const U, ValueType>::value>::type>
+        extendible_hash_map_iterator(const extendible_hash_map_iterator<U, Segment>& other) noexcept
+        : directory(other.directory), entry(other.entry), slot(other.slot), entries(other.entries) {}
+
+        reference operator*() const {
+            return directory[entry]->slots[slot]->value();
+        }
+        pointer operator->() const {
+            return **this;
+        }
+
+        // prefix ++
+        extendible_hash_map_iterator& operator++() {
+            slot++;
+            seek_helper();
+            return *this;
+        }
+        // postfix ++
+        extendible_hash_map_iterator operator++(int) {
+            extendible_hash_map_iterator old = *this;
+            ++(*this);
+            return old;
+        }
+
+        friend bool operator==(const extendible_hash_map_iterator& l_point, const extendible_hash_map_iterator& r_point) {
+            return l_point.directory == r_point.directory && l_point.entry == r_point.entry && l_point.slot == r_point.slot;
+        }
+        friend bool operator!=(const extendible_hash_map_iterator& l_point, const extendible_hash_map_iterator& r_point) {
+            return !(l_point == r_point);
+        }
+
+    private:
+        template<typename, typename>
+        friend class extendible_hash_map_iterator;
+        template<typename, typename, class, class, typename, typename>
+        friend class extendible_hash_map;
+
+        // Entry e is the first one of its segment when e < 2^local_depth.
+        // The end is (entries, 0).
+        void seek_helper() noexcept {
+            while (entry < entries) {
+                const Segment* segment = directory[entry];
+                if ((entry >> segment->local_depth) == 0) {
+                    for (; slot < Segment::width; slot++) {
+                        if (segment->slots[slot] != nullptr)
+                            return;
+                    }
+                }
+                entry++;
+                slot = 0;
+            }
+        }
+
+        Segment* const* directory;
+        size_t entry;
+        size_t slot;
+        size_t entries;
+    };
+
+
+    /**
+     *  Map with extendible hashing: a directory of 2^global_depth entries
+     *  points to fixed-size segments, and the low bits of the first hash
+     *  pick the entry. A full segment splits in two on its next local
+     *  depth bit and only the directory pointers of that segment change;
+     *  the directory doubles when a segment already uses every directory
+     *  bit, which copies pointers only.
+     *
+     *  Growth therefore costs one segment of memory and work instead of a
+     *  second full table, and no insert pauses for a rehash. Elements live
+     *  in %hash_map nodes with cached hashes, so splits move pointers
+     *  without hashing keys again and element addresses stay stable.
+     *  Inserts throw std::length_error if more keys than fit a segment
+     *  share all 32 bits of the first hash.
+     */
+    template<typename K, typename T,
+            class FirstHash = FirstKeyHash<K>,
+            class SecondHash = SecondKeyHash<K>,
+            typename Pred = std::equal_to<K>,
+            typename Alloc = allocator<std::pair<const K, T>*>>
+    class extendible_hash_map : public hash_map_container_base<extendible_hash_map<K, T, FirstHash, SecondHash, Pred, Alloc>, K, T>
+    {
+    public:
+        using key_type = K;
+        using mapped_type = T;
+        using allocator_type = Alloc;
+        using value_type = std::pair<const key_type, mapped_type>;
+        using size_type = std::size_t;
+
+    private:
+        using hash_node = hash_map_node<value_type>;
+
+        // Slots per segment, a power of two.
+        static constexpr size_type SEGMENT_SIZE = 256;
+
+        // The first hash is 32 bits wide, which bounds the directory.
+        static constexpr size_type MAX_DEPTH = 32;
+
+        using segment_type = extendible_hash_map_segment<hash_node, SEGMENT_SIZE>;
+
+        friend class hash_map_container_base<extendible_hash_map, K, T>;
+
+        void swap_helper(extendible_hash_map& x, bool allocators) {
+            std::swap(GLOBAL_DEPTH, x.GLOBAL_DEPTH);
+            std::swap(SEGMENT_COUNT, x.SEGMENT_COUNT);
+            std::swap(NOT_NULL_SIZE, x.NOT_NULL_SIZE);
+            std::swap(LOAD_FACTOR, x.LOAD_FACTOR);
+            std::swap(directory, x.directory);
+            std::swap(firstHash, x.firstHash);
+            std::swap(secondHash, x.secondHash);
+            std::swap(key_equal, x.key_equal);
+            if(allocators) {
+                std::swap(node_allocator, x.node_allocator);
+                std::swap(segment_allocator, x.segment_allocator);
+                std::swap(directory_allocator, x.directory_allocator);
+            }
+        }
+
+    public:
+        using iterator = extendible_hash_map_iterator<value_type, segment_type>;
+        using const_iterator = extendible_hash_map_iterator<const value_type, segment_type>;
+
+    private:
+        using alloc_traits = std::allocator_traits<allocator_type>;
+        using node_allocator_type = typename alloc_traits::template rebind_alloc<hash_node>;
+        using segment_allocator_type = typename alloc_traits::template rebind_alloc<segment_type>;
+        using directory_allocator_type = typename alloc_traits::template rebind_alloc<segment_type*>;
+        using node_alloc_traits = std::allocator_traits<node_allocator_type>;
+        using segment_alloc_traits = std::allocator_traits<segment_allocator_type>;
+        using directory_alloc_traits = std::allocator_traits<directory_allocator_type>;
+
+        size_type GLOBAL_DEPTH = 0;
+        size_type SEGMENT_COUNT = 0;
+        size_type NOT_NULL_SIZE = 0;
+        float LOAD_FACTOR = 0.7;
+        segment_type** directory = nullptr;
+        FirstHash firstHash;
+        SecondHash secondHash;
+        Pred key_equal;
+        node_allocator_type node_allocator{allocator_type()};
+        segment_allocator_type segment_allocator{node_allocator};
+        directory_allocator_type directory_allocator{node_allocator};
+
+        size_type directory_size_helper() const noexcept {
+            return directory == nullptr ? 0 : size_type(1) << GLOBAL_DEPTH;
+        }
+
+        // A segment splits before taking more elements than this. The
+        // limit is clamped so that one slot always stays empty, which ends
+        // every probe and backward shift.
+        size_type segment_limit_helper() const noexcept {
+            float limit = SEGMENT_SIZE * LOAD_FACTOR;
+            if(!(limit >= 1))
+                return 1;
+            if(limit >= SEGMENT_SIZE - 1)
+                return SEGMENT_SIZE - 1;
+            return static_cast<size_type>(limit);
+        }
+
+        segment_type* allocate_segment_helper(size_type local_depth) {
+            segment_type* segment = segment_alloc_traits::allocate(segment_allocator, 1);
+            segment->local_depth = local_depth;
+            segment->count = 0;
+            for(size_type x = 0; x < SEGMENT_SIZE; x++)
+                segment->slots[x] = nullptr;
+            return segment;
+        }
+
+        template<typename... _Args>
+        hash_node* create_node_helper(const hash_map_key_hash& h, _Args&&... args) {
+            hash_node* node = node_alloc_traits::allocate(node_allocator, 1);
+            try {
+                node_alloc_traits::construct(node_allocator, node->value(), std::forward<_Args>(args)...);
+            } catch(...) {
+                node_alloc_traits::deallocate(node_allocator, node, 1);
+                throw;
+            }
+            node->hash = h;
+            return node;
+        }
+
+        void destroy_node_helper(hash_node* node) noexcept {
+            node_alloc_traits::destroy(node_allocator, node->value());
+            node_alloc_traits::deallocate(node_allocator, node, 1);
+        }
+
+        // Walks the directory backwards: a segment is freed at its lowest
+        // entry, after every other entry sharing it has been looked at.
+        void release_helper() noexcept {
+            for(size_type e = directory_size_helper(); e-- > 0;) {
+                segment_type* segment = directory[e];
+                if((e >> segment->local_depth) != 0)
+                    continue;
+                for(size_type x = 0; x < SEGMENT_SIZE; x++) {
+                    if(segment->slots[x] != nullptr)
+                        destroy_node_helper(segment->slots[x]);
+                }
+                segment_alloc_traits::deallocate(segment_allocator, segment, 1);
+            }
+            if(directory != nullptr)
+                directory_alloc_traits::deallocate(directory_allocator, directory, directory_size_helper());
+            directory = nullptr;
+            GLOBAL_DEPTH = 0;
+            SEGMENT_COUNT = 0;
+            NOT_NULL_SIZE = 0;
+        }
+
+        // Clones every segment of other with fresh nodes and points the new
+        // directory entries at the clones.
+        void copy_elements_helper(const extendible_hash_map& other) {
+            if(other.directory == nullptr)
+                return;
+            size_type entries = other.directory_size_helper();
+            directory = directory_alloc_traits::allocate(directory_allocator, entries);
+            GLOBAL_DEPTH = other.GLOBAL_DEPTH;
+            for(size_type e = 0; e < entries; e++)
+                directory[e] = nullptr;
+            try {
+                for(size_type e = 0; e < entries; e++) {
+                    const segment_type* source = other.directory[e];
+                    if((e >> source->local_depth) != 0)
+                        continue;
+                    directory[e] = allocate_segment_helper(source->local_depth);
+                    SEGMENT_COUNT++;
+                    for(size_type x = 0; x < SEGMENT_SIZE; x++) {
+                        if(source->slots[x] == nullptr)
+                            continue;
+                        directory[e]->slots[x] = create_node_helper(source->slots[x]->hash, *source->slots[x]->value());
+                        directory[e]->count++;
+                        NOT_NULL_SIZE++;
+                    }
+                }
+            } catch(...) {
+                for(size_type e = 0; e < entries; e++) {
+                    segment_type* segment = directory[e];
+                    if(segment == nullptr)
+                        continue;
+                    for(size_type x = 0; x < SEGMENT_SIZE; x++) {
+                        if(segment->slots[x] != nullptr)
+                            destroy_node_helper(segment->slots[x]);
+                    }
+                    segment_alloc_traits::deallocate(segment_allocator, segment, 1);
+                }
+                directory_alloc_traits::deallocate(directory_allocator, directory, entries);
+                directory = nullptr;
+                GLOBAL_DEPTH = 0;
+                SEGMENT_COUNT = 0;
+                NOT_NULL_SIZE = 0;
+                throw;
+            }
+            for(size_type e = 0; e < entries; e++)
+                directory[e] = directory[e & ((size_type(1) << other.directory[e]->local_depth) - 1)];
+        }
+
+        void steal_elements_helper(extendible_hash_map& other) noexcept {
+            GLOBAL_DEPTH = other.GLOBAL_DEPTH;
+            SEGMENT_COUNT = other.SEGMENT_COUNT;
+            NOT_NULL_SIZE = other.NOT_NULL_SIZE;
+            directory = other.directory;
+            other.GLOBAL_DEPTH = 0;
+            other.SEGMENT_COUNT = 0;
+            other.NOT_NULL_SIZE = 0;
+            other.directory = nullptr;
+        }
+
+        iterator make_iterator(size_type e, size_type x) const {
+            return iterator(directory, e, x, directory_size_helper());
+        }
+
+        size_type entry_helper(const hash_map_key_hash& h) const noexcept {
+            return h.first & (directory_size_helper() - 1);
+        }
+
+        // Home slot in a segment. The directory entry comes from h.first,
+        // whose low bits are shared by all keys of a segment, so the slot
+        // is taken from h.second instead.
+        static size_type home_slot_helper(const hash_map_key_hash& h) noexcept {
+            return static_cast<size_type>(h.second & (SEGMENT_SIZE - 1));
+        }
+
+        // Returns the slot of key in its segment and true, or the empty
+        // slot an insert of key should use and false.
+        std::pair<size_type, bool> find_position_helper(const segment_type* segment, const key_type& key,
+                                                        const hash_map_key_hash& h) const {
+            size_type x = home_slot_helper(h);
+            for (size_type i = 0; i < SEGMENT_SIZE; i++) {
+                const hash_node* node = segment->slots[x];
+                if (node == nullptr)
+                    return {x, false};
+                if (node->hash.first == h.first && node->hash.second == h.second
+                    && key_equal(node->value()->first, key))
+                    return {x, true};
+                x = (x + 1) & (SEGMENT_SIZE - 1);
+            }
+            return {SEGMENT_SIZE, false};
+        }
+
+        void place_helper(segment_type* segment, hash_node* node) noexcept {
+            size_type x = home_slot_helper(node->hash);
+            while (segment->slots[x] != nullptr)
+                x = (x + 1) & (SEGMENT_SIZE - 1);
+            segment->slots[x] = node;
+            segment->count++;
+        }
+
+        /**
+         *  Splits the segment of directory entry e on its next depth bit.
+         *  The new segment and, if needed, the doubled directory are
+         *  allocated before anything changes, so a throw leaves the map as
+         *  it was.
+         */
+        void split_segment_helper(size_type e) {
+            segment_type* segment = directory[e];
+            size_type depth = segment->local_depth;
+            if (depth == MAX_DEPTH)
+                throw std::length_error("extendible_hash_map segment cannot split further");
+            segment_type* sibling = allocate_segment_helper(depth + 1);
+            if (depth == GLOBAL_DEPTH) {
+                size_type entries = directory_size_helper();
+                segment_type** doubled;
+                try {
+                    doubled = directory_alloc_traits::allocate(directory_allocator, 2 * entries);
+                } catch(...) {
+                    segment_alloc_traits::deallocate(segment_allocator, sibling, 1);
+                    throw;
+                }
+                for (size_type j = 0; j < 2 * entries; j++)
+                    doubled[j] = directory[j & (entries - 1)];
+                directory_alloc_traits::deallocate(directory_allocator, directory, entries);
+                directory = doubled;
+                GLOBAL_DEPTH++;
+            }
+
+            hash_node* nodes[SEGMENT_SIZE];
+            size_type n = 0;
+            for (size_type x = 0; x < SEGMENT_SIZE; x++) {
+                if (segment->slots[x] != nullptr)
+                    nodes[n++] = segment->slots[x];
+                segment->slots[x] = nullptr;
+            }
+            segment->local_depth = depth + 1;
+            segment->count = 0;
+            for (size_type i = 0; i < n; i++)
+                place_helper((nodes[i]->hash.first >> depth & 1) ? sibling : segment, nodes[i]);
+
+            size_type low = (e & ((size_type(1) << depth) - 1)) | (size_type(1) << depth);
+            for (size_type j = low; j < directory_size_helper(); j += size_type(1) << (depth + 1))
+                directory[j] = sibling;
+            SEGMENT_COUNT++;
+        }
+
+        template<typename... _Args>
+        std::pair<iterator, bool> try_emplace_helper(const key_type& k, _Args&&... args) {
+            if (directory == nullptr) {
+                segment_type* segment = allocate_segment_helper(0);
+                try {
+                    directory = directory_alloc_traits::allocate(directory_allocator, 1);
+                } catch(...) {
+                    segment_alloc_traits::deallocate(segment_allocator, segment, 1);
+                    throw;
+                }
+                directory[0] = segment;
+                SEGMENT_COUNT = 1;
+            }
+            hash_map_key_hash h = hash_key(firstHash, secondHash, k);
+            size_type e = entry_helper(h);
+            auto pos = find_position_helper(directory[e], k, h);
+            if (pos.second)
+                return {make_iterator(e & ((size_type(1) << directory[e]->local_depth) - 1), pos.first), false};
+            while (directory[e]->count + 1 > segment_limit_helper()) {
+                split_segment_helper(e);
+                e = entry_helper(h);
+            }
+            segment_type* segment = directory[e];
+            pos = find_position_helper(segment, k, h);
+            segment->slots[pos.first] = create_node_helper(h, std::piecewise_construct, std::forward_as_tuple(k),
+                                                           std::forward_as_tuple(std::forward<_Args>(args)...));
+            segment->count++;
+            NOT_NULL_SIZE++;
+            return {make_iterator(e & ((size_type(1) << segment->local_depth) - 1), pos.first), true};
+        }
+
+        // Backward-shift deletion: later members of the cluster move into
+        // the hole when their home slot allows it.
+        void erase_slot_helper(segment_type* segment, size_type x) noexcept {
+            destroy_node_helper(segment->slots[x]);
+            size_type hole = x;
+            size_type j = x;
+            for (;;) {
+                j = (j + 1) & (SEGMENT_SIZE - 1);
+                hash_node* node = segment->slots[j];
+                if (node == nullptr)
+                    break;
+                size_type home = home_slot_helper(node->hash);
+                bool movable = hole <= j ? (home <= hole || home > j) : (home <= hole && home > j);
+                if (movable) {
+                    segment->slots[hole] = node;
+                    hole = j;
+                }
+            }
+            segment->slots[hole] = nullptr;
+            segment->count--;
+            NOT_NULL_SIZE--;
+        }
+
+    public:
+        /// Default constructor. The first insert allocates a segment.
+        extendible_hash_map() {}
+
+        explicit extendible_hash_map(const allocator_type& a)
+        : node_allocator(a), segment_allocator(a), directory_allocator(a) {}
+
+        /// Copy constructor.
+        extendible_hash_map(const extendible_hash_map& other)
+        : extendible_hash_map(other, alloc_traits::select_on_container_copy_construction(other.get_allocator())) {}
+
+        /// Copy constructor with allocator argument.
+        extendible_hash_map(const extendible_hash_map& other, const allocator_type& a)
+        : LOAD_FACTOR(other.LOAD_FACTOR), firstHash(other.firstHash), secondHash(other.secondHash),
+          key_equal(other.key_equal), node_allocator(a), segment_allocator(a), directory_allocator(a) {
+            copy_elements_helper(other);
+        }
+
+        /// Move constructor.
+        extendible_hash_map(extendible_hash_map&& other)
+        : LOAD_FACTOR(other.LOAD_FACTOR), firstHash(std::move(other.firstHash)),
+          secondHash(std::move(other.secondHash)), key_equal(std::move(other.key_equal)),
+          node_allocator(std::move(other.node_allocator)), segment_allocator(std::move(other.segment_allocator)),
+          directory_allocator(std::move(other.directory_allocator)) {
+            steal_elements_helper(other);
+        }
+
+        /**
+         *  @brief  Move constructor with allocator argument.
+         *
+         *  The memory of @a other is adopted only if its allocator compares
+         *  equal to @a a; otherwise its elements are moved one by one.
+         */
+        extendible_hash_map(extendible_hash_map&& other, const allocator_type& a)
+        : LOAD_FACTOR(other.LOAD_FACTOR), firstHash(other.firstHash), secondHash(other.secondHash),
+          key_equal(other.key_equal), node_allocator(a), segment_allocator(a), directory_allocator(a) {
+            this->move_construct_helper(other);
+        }
+
+        /// Builds an %extendible_hash_map from an initializer_list.
+        extendible_hash_map(std::initializer_list<value_type> l) {
+            this->insert(l);
+        }
+
+        ~extendible_hash_map() {
+            release_helper();
+        }
+
+        /// Copy assignment operator.
+        extendible_hash_map& operator=(const extendible_hash_map& other) {
+            return this->copy_assign_helper(other);
+        }
+
+        /// Move assignment operator.
+        extendible_hash_map& operator=(extendible_hash_map&& other) {
+            return this->move_assign_helper(std::move(other));
+        }
+
+        ///  Returns the allocator object used by the %extendible_hash_map.
+        allocator_type get_allocator() const noexcept {
+            return allocator_type(node_allocator);
+        }
+
+        ///  Returns the size of the %extendible_hash_map.
+        size_type size() const noexcept {
+            return NOT_NULL_SIZE;
+        }
+
+        ///  Returns the number of slots over all segments.
+        size_type max_size() const noexcept {
+            return SEGMENT_COUNT * SEGMENT_SIZE;
+        }
+
+        /// Returns the number of directory bits in use.
+        size_type global_depth() const noexcept {
+            return GLOBAL_DEPTH;
+        }
+
+        /// Returns the number of segments.
+        size_type segment_count() const noexcept {
+            return SEGMENT_COUNT;
+        }
+
+        iterator begin() noexcept {
+            iterator it = make_iterator(0, 0);
+            it.seek_helper();
+            return it;
+        }
+
+        const_iterator begin() const noexcept {
+            const_iterator it = make_iterator(0, 0);
+            it.seek_helper();
+            return it;
+        }
+
+        iterator end() noexcept {
+            return make_iterator(directory_size_helper(), 0);
+        }
+
+        const_iterator end() const noexcept {
+            return make_iterator(directory_size_helper(), 0);
+        }
+
+        /**
+         *  @brief Erases elements according to the provided key.
+         *  @param  key  Key of element to be erased.
+         *  @return  The number of elements erased.
+         */
+        size_type erase(const key_type& key) {
+            if (directory == nullptr)
+                return 0;
+            hash_map_key_hash h = hash_key(firstHash, secondHash, key);
+            segment_type* segment = directory[entry_helper(h)];
+            auto pos = find_position_helper(segment, key, h);
+            if (!pos.second)
+                return 0;
+            erase_slot_helper(segment, pos.first);
+            return 1;
+        }
+
+        /// Erases all elements and releases every segment.
+        void clear() noexcept {
+            release_helper();
+        }
+
+        //@{
+        /**
+         *  @brief Tries to locate an element in an %extendible_hash_map.
+         *  @param  key  Key to be located.
+         *  @return  Iterator pointing to sought-after element, or end() if not
+         *           found.
+         */
+        iterator find(const key_type& key) {
+            if (directory == nullptr)
+                return end();
+            hash_map_key_hash h = hash_key(firstHash, secondHash, key);
+            size_type e = entry_helper(h);
+            auto pos = find_position_helper(directory[e], key, h);
+            if (!pos.second)
+                return end();
+            return make_iterator(e & ((size_type(1) << directory[e]->local_depth) - 1), pos.first);
+        }
+
+        const_iterator find(const key_type& key) const {
+            return const_cast<extendible_hash_map*>(this)->find(key);
+        }
+        //@}
+
+        /// Returns the average number of elements per slot.
+        float load_factor() const noexcept {
+            return SEGMENT_COUNT == 0 ? 0 : (float)NOT_NULL_SIZE / (float)max_size();
+        }
+
+        /// Returns the load at which a segment splits.
+        float max_load_factor() const noexcept {
+            return LOAD_FACTOR;
+        }
+
+        /**
+         *  @brief  Changes the load at which a segment splits. Takes effect
+         *  as segments fill; segments already above it are left alone.
+         *  Values outside (0, 1) are clamped so that a segment keeps at
+         *  least one empty slot.
+         */
+        void max_load_factor(float z) {
+            LOAD_FACTOR = z;
+        }
+
+        /**
+         *  @brief  Returns the bytes held by the %extendible_hash_map.
+         *
+         *  Directory entries and segment slots count as table, the segment
+         *  headers as metadata.
+         */
+        hash_map_memory_usage memory_usage() const noexcept {
+            hash_map_memory_usage usage{0, 0, 0, 0, 0, table_backing::allocator};
+            usage.table = directory_size_helper() * sizeof(segment_type*) + max_size() * sizeof(hash_node*);
+            usage.metadata = SEGMENT_COUNT * (sizeof(segment_type) - SEGMENT_SIZE * sizeof(hash_node*));
+            usage.nodes = NOT_NULL_SIZE * sizeof(hash_node);
+            usage.slack = (max_size() - NOT_NULL_SIZE) * sizeof(hash_node*);
+            return usage;
+        }
+    };
+
+    template<typename K, typename T, class FirstHash, class SecondHash, typename Pred, typename Alloc>
+    constexpr std::size_t extendible_hash_map<K, T, FirstHash, SecondHash, Pred, Alloc>::SEGMENT_SIZE;
+
+    template<typename K, typename T, class FirstHash, class SecondHash, typename Pred, typename Alloc>
+    constexpr std::size_t extendible_hash_map<K, T, FirstHash, SecondHash, Pred, Alloc>::MAX_DEPTH;
+
+} // namespace fefu
+
+
+
+#endif //HASHMAP_EXTENDIBLE_HASH_MAP_H
@@ -13,10 +13,40 @@
 #include <utility>
 #include <type_traits>
 #include <iostream>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define FEFU_HAS_MMAN
+#endif
+
+#if UINTPTR_MAX > 0xFFFFFFFFu && !defined(FEFU_HASH_MAP_NO_POINTER_TAGS)
+#define FEFU_HASH_MAP_POINTER_TAGS
+#endif
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#define FEFU_HAS_MEMORY_RESOURCE
+#endif
+#endif
 
 namespace fefu
 {
 
+    /**
+     *  Default hash functors of a %hash_map. A functor is called as
+     *  hash(key, range) and returns a value below range. The map calls
+     *  each functor once per key with range 0xFFFFFFFF, keeps the two
+     *  32-bit results, and derives probe positions for every table size
+     *  from them, so a functor must not assume range is the table size.
+     *  The results are mixed before a fingerprint is taken from them, so
+     *  functors that return the key itself are fine.
+     */
     template <typename K>
     struct FirstKeyHash {
         long operator()(const K& key, size_t table_size) const {
@@ -49,6 +79,11 @@ namespace fefu
         using const_reference = typename std::add_lvalue_reference<const T>::type;
         using value_type = T;
 
+        allocator() noexcept = default;
+
+        template<typename U>
+        allocator(const allocator<U>&) noexcept {}
+
         pointer allocate(size_type n) {
             return static_cast<pointer>( ::operator new(n*sizeof(T)));
         }
@@ -59,63 +94,705 @@ namespace fefu
         }
     };
 
+    template<typename T, typename U>
+    bool operator==(const allocator<T>&, const allocator<U>&) noexcept {
+        return true;
+    }
+
+    template<typename T, typename U>
+    bool operator!=(const allocator<T>&, const allocator<U>&) noexcept {
+        return false;
+    }
+
+    /**
+     *  Memory shared by node_pool_allocator copies and rebinds.
+     *
+     *  Fixed-size slots are carved out of large slabs, with one size class
+     *  per slot size. Freed slots are recycled through an intrusive free
+     *  list and slabs are only returned to the system by release() or by
+     *  the destructor. Slots of one slab are handed out in address order,
+     *  so nodes inserted together end up next to each other.
+     *  Not thread safe.
+     */
+    class node_pool {
+    public:
+        using size_type = std::size_t;
+
+        explicit node_pool(size_type nodes_per_slab = 256) : nodes_per_slab(nodes_per_slab) {}
+
+        node_pool(const node_pool&) = delete;
+        node_pool& operator=(const node_pool&) = delete;
+
+        ~node_pool() {
+            for(size_class& sc : classes)
+                release_class_helper(sc);
+        }
+
+        /// Rounds an object size up to a slot able to hold it and a free list link.
+        static constexpr size_type slot_size(size_type size, size_type alignment) noexcept {
+            return ((size < sizeof(free_slot) ? sizeof(free_slot) : size) + alignment - 1) / alignment * alignment;
+        }
+
+        void* allocate(size_type size) {
+            size_class& sc = find_class_helper(size);
+            if(sc.free_list == nullptr)
+                grow_helper(sc);
+            free_slot* slot = sc.free_list;
+            sc.free_list = slot->next;
+            sc.allocated++;
+            return slot;
+        }
+
+        void deallocate(void* p, size_type size) noexcept {
+            size_class& sc = find_class_helper(size);
+            free_slot* slot = static_cast<free_slot*>(p);
+            slot->next = sc.free_list;
+            sc.free_list = slot;
+            sc.allocated--;
+        }
+
+        /// Number of slots of the given size currently handed out.
+        size_type allocated(size_type size) const noexcept {
+            for(const size_class& sc : classes)
+                if(sc.slot_size == size)
+                    return sc.allocated;
+            return 0;
+        }
+
+        /**
+         *  Frees every slab of the given size class at once. Slots still
+         *  handed out become dangling, so callers check allocated() first.
+         */
+        void release(size_type size) noexcept {
+            for(size_class& sc : classes)
+                if(sc.slot_size == size)
+                    release_class_helper(sc);
+        }
+
+    private:
+        struct free_slot {
+            free_slot* next;
+        };
+
+        struct slab {
+            slab* next;
+        };
+
+        struct size_class {
+            size_type slot_size;
+            free_slot* free_list;
+            slab* slabs;
+            size_type allocated;
+        };
+
+        static constexpr size_type slab_header = (sizeof(slab) + alignof(std::max_align_t) - 1)
+                                                 / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+        size_class& find_class_helper(size_type size) {
+            for(size_class& sc : classes)
+                if(sc.slot_size == size)
+                    return sc;
+            classes.push_back({size, nullptr, nullptr, 0});
+            return classes.back();
+        }
+
+        void grow_helper(size_class& sc) {
+            char* memory = static_cast<char*>(::operator new(slab_header + nodes_per_slab * sc.slot_size));
+            slab* new_slab = reinterpret_cast<slab*>(memory);
+            new_slab->next = sc.slabs;
+            sc.slabs = new_slab;
+
+            // Linked back to front so that the lowest address is handed out first.
+            char* slots = memory + slab_header;
+            for(size_type i = nodes_per_slab; i > 0; i--) {
+                free_slot* slot = reinterpret_cast<free_slot*>(slots + (i - 1) * sc.slot_size);
+                slot->next = sc.free_list;
+                sc.free_list = slot;
+            }
+        }
+
+        void release_class_helper(size_class& sc) noexcept {
+            while(sc.slabs) {
+                slab* next = sc.slabs->next;
+                ::operator delete(static_cast<void*>(sc.slabs));
+                sc.slabs = next;
+            }
+            sc.free_list = nullptr;
+            sc.allocated = 0;
+        }
+
+        size_type nodes_per_slab;
+        std::vector<size_class> classes;
+    };
+
+    /**
+     *  Allocator handing out single objects from a shared node_pool, meant
+     *  as the Alloc of a %hash_map. Requests for more than one object (the
+     *  slot table) go to ::operator new. Copies and rebinds share the pool
+     *  and compare equal, so nodes can move between maps using it. A copied
+     *  %hash_map gets a pool of its own.
+     */
+    template<typename T>
+    class node_pool_allocator {
+    public:
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using const_pointer = const T*;
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        node_pool_allocator() : pool(std::make_shared<node_pool>()) {}
+
+        explicit node_pool_allocator(std::shared_ptr<node_pool> pool) noexcept : pool(std::move(pool)) {}
+
+        // Deliberately copies on move too, so a moved-from allocator still
+        // refers to a pool.
+        node_pool_allocator(const node_pool_allocator& other) noexcept : pool(other.pool) {}
+
+        template<typename U>
+        node_pool_allocator(const node_pool_allocator<U>& other) noexcept : pool(other.pool) {}
+
+        node_pool_allocator& operator=(const node_pool_allocator& other) noexcept {
+            pool = other.pool;
+            return *this;
+        }
+
+        pointer allocate(size_type n) {
+            if(n == 1 && pooled)
+                return static_cast<pointer>(pool->allocate(slot));
+            return static_cast<pointer>(::operator new(n * sizeof(T)));
+        }
+
+        void deallocate(pointer p, size_type n) noexcept {
+            if(n == 1 && pooled)
+                pool->deallocate(p, slot);
+            else
+                ::operator delete(static_cast<void*>(p));
+        }
+
+        node_pool_allocator select_on_container_copy_construction() const {
+            return node_pool_allocator();
+        }
+
+        /// Number of objects of this size currently handed out by the pool.
+        size_type allocated() const noexcept {
+            return pool->allocated(slot);
+        }
+
+        /// Frees every slab of this size class at once, see node_pool::release().
+        void release() noexcept {
+            pool->release(slot);
+        }
+
+        const std::shared_ptr<node_pool>& resource() const noexcept {
+            return pool;
+        }
+
+    private:
+        template<typename U>
+        friend class node_pool_allocator;
+
+        static constexpr bool pooled = alignof(T) <= alignof(std::max_align_t);
+        static constexpr size_type slot = node_pool::slot_size(sizeof(T), alignof(T) < alignof(void*) ? alignof(void*) : alignof(T));
+
+        std::shared_ptr<node_pool> pool;
+    };
+
+    template<typename T, typename U>
+    bool operator==(const node_pool_allocator<T>& l, const node_pool_allocator<U>& r) noexcept {
+        return l.resource() == r.resource();
+    }
+
+    template<typename T, typename U>
+    bool operator!=(const node_pool_allocator<T>& l, const node_pool_allocator<U>& r) noexcept {
+        return !(l == r);
+    }
+
+    /**
+     *  Bump allocator for request-scoped containers, with the same
+     *  allocate / deallocate / release interface as
+     *  std::pmr::monotonic_buffer_resource.
+     *
+     *  Memory is handed out from chunks of geometrically growing size (or
+     *  from a caller supplied buffer first). deallocate() does nothing;
+     *  everything is returned at once by release() or the destructor.
+     *  Not thread safe.
+     */
+    class monotonic_arena {
+    public:
+        using size_type = std::size_t;
+
+        explicit monotonic_arena(size_type initial_size = 4096) noexcept
+        : initial_buffer(nullptr), initial_size(0), next_size(initial_size ? initial_size : 1) {
+            reset_helper();
+        }
+
+        monotonic_arena(void* buffer, size_type buffer_size) noexcept
+        : initial_buffer(buffer), initial_size(buffer_size), next_size(buffer_size ? buffer_size : 1) {
+            reset_helper();
+        }
+
+        monotonic_arena(const monotonic_arena&) = delete;
+        monotonic_arena& operator=(const monotonic_arena&) = delete;
+
+        ~monotonic_arena() {
+            release();
+        }
+
+        void* allocate(size_type bytes, size_type alignment = alignof(std::max_align_t)) {
+            void* p = current;
+            size_type space = end - current;
+            if(std::align(alignment, bytes, p, space) == nullptr) {
+                grow_helper(bytes + alignment);
+                p = current;
+                space = end - current;
+                std::align(alignment, bytes, p, space);
+            }
+            current = static_cast<char*>(p) + bytes;
+            return p;
+        }
+
+        void deallocate(void*, size_type, size_type = alignof(std::max_align_t)) noexcept {}
+
+        /// Frees every chunk; memory handed out so far becomes invalid.
+        void release() noexcept {
+            while(chunks) {
+                chunk* next = chunks->next;
+                ::operator delete(static_cast<void*>(chunks));
+                chunks = next;
+            }
+            reset_helper();
+        }
+
+    private:
+        struct chunk {
+            chunk* next;
+        };
+
+        void reset_helper() noexcept {
+            chunks = nullptr;
+            current = static_cast<char*>(initial_buffer);
+            end = current + initial_size;
+        }
+
+        void grow_helper(size_type at_least) {
+            size_type size = next_size;
+            while(size < at_least)
+                size *= 2;
+            char* memory = static_cast<char*>(::operator new(sizeof(chunk) + size));
+            chunk* new_chunk = reinterpret_cast<chunk*>(memory);
+            new_chunk->next = chunks;
+            chunks = new_chunk;
+            current = memory + sizeof(chunk);
+            end = current + size;
+            next_size = 2 * size;
+        }
+
+        void* initial_buffer;
+        size_type initial_size;
+        size_type next_size;
+        chunk* chunks;
+        char* current;
+        char* end;
+    };
+
+    /// Tells whether deallocate() of a memory resource is a no-op. Specialize
+    /// it for other monotonic resources, e.g. std::pmr::monotonic_buffer_resource.
+    template<typename Resource>
+    struct is_monotonic_resource : std::false_type {};
+
+    template<>
+    struct is_monotonic_resource<monotonic_arena> : std::true_type {};
+
+#ifdef FEFU_HAS_MEMORY_RESOURCE
+    template<>
+    struct is_monotonic_resource<std::pmr::monotonic_buffer_resource> : std::true_type {};
+#endif
+
+    /**
+     *  Allocator drawing everything from a memory resource it does not own,
+     *  by default a monotonic_arena. Any resource with pmr style
+     *  allocate(bytes, alignment) / deallocate(p, bytes, alignment), such
+     *  as std::pmr::monotonic_buffer_resource, can be plugged in.
+     */
+    template<typename T, typename Resource = monotonic_arena>
+    class arena_allocator {
+    public:
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using const_pointer = const T*;
+        using value_type = T;
+
+        arena_allocator(Resource* arena) noexcept : arena(arena) {}
+
+        template<typename U>
+        arena_allocator(const arena_allocator<U, Resource>& other) noexcept : arena(other.resource()) {}
+
+        pointer allocate(size_type n) {
+            return static_cast<pointer>(arena->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(pointer p, size_type n) noexcept {
+            arena->deallocate(p, n * sizeof(T), alignof(T));
+        }
+
+        Resource* resource() const noexcept {
+            return arena;
+        }
+
+    private:
+        Resource* arena;
+    };
+
+    template<typename T, typename U, typename Resource>
+    bool operator==(const arena_allocator<T, Resource>& l, const arena_allocator<U, Resource>& r) noexcept {
+        return l.resource() == r.resource();
+    }
+
+    template<typename T, typename U, typename Resource>
+    bool operator!=(const arena_allocator<T, Resource>& l, const arena_allocator<U, Resource>& r) noexcept {
+        return !(l == r);
+    }
+
+    /// Tells whether deallocate() of an allocator is a no-op.
+    template<typename Alloc>
+    struct is_monotonic_allocator : std::false_type {};
+
+    template<typename T, typename Resource>
+    struct is_monotonic_allocator<arena_allocator<T, Resource>> : is_monotonic_resource<Resource> {};
+
+    /// Where the slot table of a %hash_map lives.
+    enum class table_backing {
+        allocator,  ///< obtained from the container's allocator
+        mapped,     ///< anonymous mapping, the kernel refused huge pages
+        huge_pages, ///< anonymous mapping advised to use transparent huge pages
+        embedded    ///< single slot group inside the %hash_map object
+    };
+
+    /**
+     *  Anonymous memory mappings for large slot tables. The region is
+     *  rounded up and aligned to 2MB so that the kernel can back all of it
+     *  with huge pages, and it comes zero filled.
+     */
+    struct huge_page_region {
+        static constexpr std::size_t page_size = 2 * 1024 * 1024;
+
+        static std::size_t mapping_size(std::size_t bytes) noexcept {
+            return (bytes + page_size - 1) / page_size * page_size;
+        }
+
+        /// Returns nullptr if no mapping could be made.
+        static void* map(std::size_t bytes, bool populate, table_backing& backing) noexcept {
+#ifdef FEFU_HAS_MMAN
+            std::size_t size = mapping_size(bytes);
+            // Over-map by one huge page and trim, to get a 2MB aligned start.
+            std::size_t padded = size + page_size;
+            void* raw = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if(raw == MAP_FAILED)
+                return nullptr;
+            char* begin = static_cast<char*>(raw);
+            char* aligned = reinterpret_cast<char*>((reinterpret_cast<std::uintptr_t>(begin) + page_size - 1)
+                                                    / page_size * page_size);
+            if(aligned != begin)
+                munmap(begin, aligned - begin);
+            if(aligned + size != begin + padded)
+                munmap(aligned + size, begin + padded - (aligned + size));
+
+            backing = table_backing::mapped;
+#ifdef MADV_HUGEPAGE
+            if(madvise(aligned, size, MADV_HUGEPAGE) == 0)
+                backing = table_backing::huge_pages;
+#endif
+#ifdef MADV_POPULATE_WRITE
+            if(populate)
+                madvise(aligned, size, MADV_POPULATE_WRITE);
+#else
+            if(populate) {
+                for(std::size_t offset = 0; offset < size; offset += 4096)
+                    aligned[offset] = 0;
+            }
+#endif
+            return aligned;
+#else
+            (void)bytes;
+            (void)populate;
+            (void)backing;
+            return nullptr;
+#endif
+        }
+
+        static void unmap(void* p, std::size_t bytes) noexcept {
+#ifdef FEFU_HAS_MMAN
+            munmap(p, mapping_size(bytes));
+#else
+            (void)p;
+            (void)bytes;
+#endif
+        }
+    };
+
+    /// Bytes held by a %hash_map, as reported by hash_map::memory_usage().
+    struct hash_map_memory_usage {
+        std::size_t table;       ///< slot pointers, including empty slots
+        std::size_t metadata;    ///< slot state words and alignment padding
+        std::size_t nodes;       ///< live element nodes, with their cached hashes
+        std::size_t slack;       ///< slots not holding an element, and padding
+        std::size_t tombstones;  ///< part of slack held by erased slots
+        table_backing backing;   ///< where table and metadata live
+
+        /// Table, metadata and nodes; slack and tombstones are already included.
+        std::size_t total() const noexcept {
+            return table + metadata + nodes;
+        }
+    };
+
+    // Detects allocators that can drop all their nodes at once, such as
+    // node_pool_allocator.
+    template<typename Alloc, typename = void>
+    struct is_bulk_releasable : std::false_type {};
+
+    template<typename Alloc>
+    struct is_bulk_releasable<Alloc, decltype(std::declval<Alloc&>().release(),
+                                              std::declval<const Alloc&>().allocated(), void())> : std::true_type {};
+
+    /// Results of both hash functors of a %hash_map for one key.
+    struct hash_map_key_hash {
+        std::uint32_t first;
+        std::uint32_t second;
+    };
+
+    /**
+     *  @brief  Hashes a key for the maps of this library.
+     *  @param  first   First hash functor of the map.
+     *  @param  second  Second hash functor of the map.
+     *  @param  key     Key to hash.
+     *
+     *  Each functor is called once, with the whole 32-bit range as table
+     *  size. Probe positions for any table size are derived from the
+     *  results, so maps keep them for later rehashes. The functors are
+     *  taken by value, as the standard algorithms take theirs; a reference
+     *  to an empty functor member trips -Wmaybe-uninitialized in gcc.
+     */
+    template<class FirstHash, class SecondHash, typename K>
+    hash_map_key_hash hash_key(FirstHash first, SecondHash second, const K& key) {
+        const std::size_t range = 0xFFFFFFFFu;
+        return {static_cast<std::uint32_t>(first(key, range)),
+                static_cast<std::uint32_t>(second(key, range))};
+    }
+
+    /**
+     *  Heap node of a %hash_map element. The hash values of the key are
+     *  kept in front of the element, so the table can be rebuilt without
+     *  hashing any key again, and a probe compares them before calling
+     *  the key predicate.
+     */
+    template<typename Value>
+    struct hash_map_node {
+        hash_map_key_hash hash;
+        typename std::aligned_storage<sizeof(Value), alignof(Value)>::type storage;
+
+        Value* value() noexcept {
+            return reinterpret_cast<Value*>(&storage);
+        }
+
+        const Value* value() const noexcept {
+            return reinterpret_cast<const Value*>(&storage);
+        }
+    };
+
+    /**
+     *  Slot of a %hash_map table. User space addresses of 64-bit targets
+     *  fit in 48 bits, so the upper 16 bits of the node pointer carry a
+     *  fingerprint of the key: lookups compare fingerprints first and only
+     *  dereference nodes whose fingerprint matches. Define
+     *  FEFU_HASH_MAP_NO_POINTER_TAGS on platforms that keep data in the
+     *  upper pointer bits, e.g. with hardware memory tagging.
+     */
+    template<typename Node>
+    class tagged_node_ptr {
+    public:
+        tagged_node_ptr() noexcept = default;
+
+        tagged_node_ptr(std::nullptr_t) noexcept : bits(0) {}
+
+        tagged_node_ptr(Node* node, std::uint16_t tag) noexcept
+        : bits(reinterpret_cast<std::uintptr_t>(node) | tag_bits(tag)) {}
+
+        Node* get() const noexcept {
+            return reinterpret_cast<Node*>(bits & address_mask());
+        }
+
+        operator Node*() const noexcept {
+            return get();
+        }
+
+        Node* operator->() const noexcept {
+            return get();
+        }
+
+        Node& operator*() const noexcept {
+            return *get();
+        }
+
+        std::uint16_t tag() const noexcept {
+#ifdef FEFU_HASH_MAP_POINTER_TAGS
+            return static_cast<std::uint16_t>(bits >> 48);
+#else
+            return 0;
+#endif
+        }
+
+        bool has_tag(std::uint16_t tag) const noexcept {
+            return (bits & ~address_mask()) == tag_bits(tag);
+        }
+
+    private:
+#ifdef FEFU_HASH_MAP_POINTER_TAGS
+        static constexpr std::uintptr_t address_mask() noexcept {
+            return (std::uintptr_t(1) << 48) - 1;
+        }
+
+        static constexpr std::uintptr_t tag_bits(std::uint16_t tag) noexcept {
+            return std::uintptr_t(tag) << 48;
+        }
+#else
+        static constexpr std::uintptr_t address_mask() noexcept {
+            return ~std::uintptr_t(0);
+        }
+
+        static constexpr std::uintptr_t tag_bits(std::uint16_t) noexcept {
+            return 0;
+        }
+#endif
+
+        std::uintptr_t bits;
+    };
+
+    /// State of a %hash_map slot, kept in two bits.
+    enum class slot_state : std::uint8_t {
+        empty = 0,
+        full = 1,
+        deleted = 2,
+        pending = 3     // holds an element not yet at its final position
+    };
+
+    /// Position of the lowest set bit of a non-zero mask.
+    inline std::size_t lowest_bit(std::uint64_t mask) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<std::size_t>(__builtin_ctzll(mask));
+#else
+        std::size_t bit = 0;
+        while(!(mask & 1u)) {
+            mask >>= 1;
+            bit++;
+        }
+        return bit;
+#endif
+    }
+
+    /**
+     *  One cache line of a %hash_map table: the states of its slots packed
+     *  two bits each into a header word, followed by the slots. A probe
+     *  reads a slot and its state from the same line, and whole groups are
+     *  scanned through the header with mask operations. The slot type is
+     *  a parameter so that narrower slots pack more lanes into the line.
+     */
+    template<typename Node, typename Slot = tagged_node_ptr<Node>>
+    struct hash_map_slot_group {
+        using slot_type = Slot;
+
+        static constexpr std::size_t line_size = 64;
+        static constexpr std::size_t width = (line_size - sizeof(std::uint64_t)) / sizeof(slot_type);
+
+        std::uint64_t states;
+        slot_type slots[width];
+
+        slot_state state(std::size_t lane) const noexcept {
+            return static_cast<slot_state>((states >> (2 * lane)) & 3u);
+        }
+
+        void set_state(std::size_t lane, slot_state state) noexcept {
+            states = (states & ~(std::uint64_t(3) << (2 * lane)))
+                     | (std::uint64_t(state) << (2 * lane));
+        }
+
+        // Bit 2 * lane is set for every lane holding an element, full or
+        // pending.
+        std::uint64_t occupied() const noexcept {
+            return states & low_bits();
+        }
+
+        // Bit 2 * lane is set for every lane in the given state.
+        std::uint64_t match(slot_state state) const noexcept {
+            std::uint64_t diff = states ^ (low_bits() * std::uint64_t(state));
+            return ~(diff | (diff >> 1)) & low_bits();
+        }
+
+        // Bit 2 * lane is set for every lane without a placed element:
+        // empty, deleted or pending.
+        std::uint64_t available() const noexcept {
+            return ~match(slot_state::full) & low_bits();
+        }
+
+        // Lane of the lowest bit set in a mask returned by occupied() or
+        // match().
+        static std::size_t first_lane(std::uint64_t mask) noexcept {
+            return lowest_bit(mask) / 2;
+        }
+
+    private:
+        static constexpr std::uint64_t low_bits() noexcept {
+            return width * 2 >= 64 ? 0x5555555555555555ull
+                                   : 0x5555555555555555ull & ((std::uint64_t(1) << (2 * width)) - 1);
+        }
+    };
+
+    template<typename Node, typename Slot>
+    constexpr std::size_t hash_map_slot_group<Node, Slot>::line_size;
+
+    template<typename Node, typename Slot>
+    constexpr std::size_t hash_map_slot_group<Node, Slot>::width;
+
     template<typename ValueType>
     class hash_map_iterator {
     public:
         using iterator_category = std::forward_iterator_tag;
         using value_type = ValueType;
         using difference_type = std::ptrdiff_t;
-        using reference = ValueType&;
-        using pointer = ValueType*;
+        // Slots hold tagged pointers, so the element pointer is handed out
+        // by value.
+        using reference = ValueType;
+        using pointer = ValueType;
+        using group_type = hash_map_slot_group<hash_map_node<typename std::remove_pointer<ValueType>::type>>;
 
         hash_map_iterator() noexcept {}
 
-        hash_map_iterator(pointer point, bool* deleted, size_t cur_index, size_t size): point(point) {
-            this->deleted = new bool[size];
-            for(int i = 0;i < size; i++)
-                this->deleted[i] = deleted[i];
-            this->cur_index = cur_index;
-            this->size = size;
-        }
+        // groups is the live table of the owning %hash_map, so building an
+        // iterator is O(1).
+        hash_map_iterator(group_type* groups, size_t cur_index, size_t size) noexcept
+        : groups(groups), cur_index(cur_index), size(size) {}
 
-        hash_map_iterator(const value_type& point, bool* deleted, size_t size) noexcept {
-            this->point = point;
-            this->deleted = new bool[size];
-            for(int i = 0;i < size; i++)
-                this->deleted[i] = deleted[i];
-            this->cur_index = cur_index;
-            this-size = size;
-        }
+        hash_map_iterator(const hash_map_iterator& other) noexcept
+        : groups(other.groups), cur_index(other.cur_index), size(other.size) {}
 
-        hash_map_iterator(const hash_map_iterator& other) noexcept {
-            point = other.point;
-            this->deleted = new bool[other.size];
-            for(int i = 0; i < other.size; i++)
-                this->deleted[i] = other.deleted[i];
-            this->cur_index = other.cur_index;
-            this->size = other.size;
-        }
+        hash_map_iterator& operator=(const hash_map_iterator& other) noexcept = default;
 
 
         reference operator*() const {
-            return *point;
+            return groups[cur_index / group_type::width].slots[cur_index % group_type::width]->value();
         }
         pointer operator->() const {
-            return point;
+            return **this;
         }
 
         // prefix ++
         hash_map_iterator& operator++() {
-            point++;
             cur_index++;
-            while (cur_index < size) {
-                if(*point != nullptr && deleted[cur_index] == false)
-                    return *this;
-                else {
-                    point++;
-                    cur_index++;
-                }
-            }
+            seek_helper();
             return *this;
         }
         // postfix ++
@@ -124,15 +801,31 @@ namespace fefu
         }
 
         friend bool operator==(const hash_map_iterator<ValueType>& l_point, const hash_map_iterator<ValueType>& r_point) {
-            return l_point.point == r_point.point;
+            return l_point.groups == r_point.groups && l_point.cur_index == r_point.cur_index;
         }
         friend bool operator!=(const hash_map_iterator<ValueType>& l_point, const hash_map_iterator<ValueType>& r_point) {
             return !(l_point == r_point);
         }
 
     private:
-        pointer point;
-        bool* deleted;
+        template<typename, typename, class, class, typename, typename, typename>
+        friend class hash_map;
+
+        // Moves to the first element at or after cur_index, a group at a time.
+        void seek_helper() noexcept {
+            while (cur_index < size) {
+                size_t lane = cur_index % group_type::width;
+                std::uint64_t mask = groups[cur_index / group_type::width].occupied() >> (2 * lane);
+                if (mask) {
+                    cur_index += group_type::first_lane(mask);
+                    return;
+                }
+                cur_index += group_type::width - lane;
+            }
+            cur_index = size;
+        }
+
+        group_type* groups;
         size_t cur_index;
         size_t size;
     };
@@ -145,51 +838,31 @@ namespace fefu
         using iterator_category = std::forward_iterator_tag;
         using value_type = ValueType;
         using difference_type = std::ptrdiff_t;
-        using reference = const ValueType&;
-        using pointer = const ValueType*;
+        using reference = const typename std::remove_pointer<ValueType>::type*;
+        using pointer = reference;
+        using group_type = hash_map_slot_group<hash_map_node<typename std::remove_pointer<ValueType>::type>>;
 
         hash_map_const_iterator() noexcept {}
-        hash_map_const_iterator(const hash_map_const_iterator& other) noexcept {
-            point = other.point;
-        }
+        hash_map_const_iterator(const hash_map_const_iterator& other) noexcept
+        : groups(other.groups), cur_index(other.cur_index), size(other.size) {}
 
-        hash_map_const_iterator(pointer point, bool* deleted, size_t cur_index, size_t size): point(point) {
-                this->deleted = new bool[size];
-                for(int i = 0;i < size; i++)
-                    this->deleted[i] = deleted[i];
-                this->cur_index = cur_index;
-                this->size = size;
-        }
-        //ash_map_const_iterator(const hash_map_iterator<ValueType>& other) noexcept;
+        hash_map_const_iterator& operator=(const hash_map_const_iterator& other) noexcept = default;
 
-        hash_map_const_iterator(const value_type& point, bool* deleted, size_t cur_index, size_t size) noexcept {
-            this->point = point;
-            this->deleted = new bool[size];
-            for(int i = 0;i < size; i++)
-                this->deleted[i] = deleted[i];
-            this->cur_index = cur_index;
-            this-size = size;
-        }
+        hash_map_const_iterator(const group_type* groups, size_t cur_index, size_t size) noexcept
+        : groups(groups), cur_index(cur_index), size(size) {}
+        //ash_map_const_iterator(const hash_map_iterator<ValueType>& other) noexcept;
 
         reference operator*() const {
-            return *point;
+            return groups[cur_index / group_type::width].slots[cur_index % group_type::width]->value();
         }
         pointer operator->() const {
-            return **point;
+            return **this;
         }
 
         // prefix ++
         hash_map_const_iterator& operator++() {
-            point++;
             cur_index++;
-            while (cur_index < size) {
-                if(*point != nullptr && deleted[cur_index] == false)
-                    return *this;
-                else {
-                    point++;
-                    cur_index++;
-                }
-            }
+            seek_helper();
             return *this;
         }
         // postfix ++
@@ -198,25 +871,271 @@ namespace fefu
         }
 
         friend bool operator==(const hash_map_const_iterator<ValueType>& l_point, const hash_map_const_iterator<ValueType>& r_point) {
-            return l_point.point == r_point.point;
+            return l_point.groups == r_point.groups && l_point.cur_index == r_point.cur_index;
         }
         friend bool operator!=(const hash_map_const_iterator<ValueType>& l_point, const hash_map_const_iterator<ValueType>& r_point) {
             return !(l_point == r_point);
         }
 
     private:
-        const ValueType* point;
-        bool* deleted;
+        template<typename, typename, class, class, typename, typename, typename>
+        friend class hash_map;
+
+        void seek_helper() noexcept {
+            while (cur_index < size) {
+                size_t lane = cur_index % group_type::width;
+                std::uint64_t mask = groups[cur_index / group_type::width].occupied() >> (2 * lane);
+                if (mask) {
+                    cur_index += group_type::first_lane(mask);
+                    return;
+                }
+                cur_index += group_type::width - lane;
+            }
+            cur_index = size;
+        }
+
+        const group_type* groups;
         size_t cur_index;
         size_t size;
     };
 
 
+    /**
+     *  Owns a single %hash_map element detached from its container by
+     *  extract(), together with a copy of the allocator that created it.
+     *  The node can be handed to insert() of another %hash_map of the same
+     *  type without reallocating or copying the element.
+     */
+    template<typename K, typename T, typename NodeAlloc>
+    class hash_map_node_handle {
+    public:
+        using key_type = K;
+        using mapped_type = T;
+        using value_type = std::pair<const key_type, mapped_type>;
+        using allocator_type = NodeAlloc;
+
+        hash_map_node_handle() noexcept : node(nullptr) {}
+
+        hash_map_node_handle(hash_map_node_handle&& other) noexcept : node(nullptr) {
+            take_from_helper(other);
+        }
+
+        hash_map_node_handle& operator=(hash_map_node_handle&& other) noexcept {
+            if(this != &other) {
+                reset_helper();
+                take_from_helper(other);
+            }
+            return *this;
+        }
+
+        hash_map_node_handle(const hash_map_node_handle&) = delete;
+        hash_map_node_handle& operator=(const hash_map_node_handle&) = delete;
+
+        ~hash_map_node_handle() {
+            reset_helper();
+        }
+
+        bool empty() const noexcept {
+            return node == nullptr;
+        }
+
+        explicit operator bool() const noexcept {
+            return node != nullptr;
+        }
+
+        allocator_type get_allocator() const {
+            return *allocator_helper();
+        }
+
+        const key_type& key() const {
+            return node->value()->first;
+        }
+
+        mapped_type& mapped() const {
+            return node->value()->second;
+        }
+
+        void swap(hash_map_node_handle& other) noexcept {
+            hash_map_node_handle temp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(temp);
+        }
+
+    private:
+        using node_alloc_traits = std::allocator_traits<allocator_type>;
+
+        template<typename, typename, class, class, typename, typename, typename>
+        friend class hash_map;
+
+        // The allocator lives in raw storage so that an empty handle does
+        // not require a default constructible allocator.
+        hash_map_node_handle(hash_map_node<value_type>* node, const allocator_type& a) : node(node) {
+            ::new(static_cast<void*>(&alloc_storage)) allocator_type(a);
+        }
+
+        allocator_type* allocator_helper() const {
+            return reinterpret_cast<allocator_type*>(const_cast<alloc_storage_type*>(&alloc_storage));
+        }
+
+        hash_map_node<value_type>* release() noexcept {
+            hash_map_node<value_type>* result = node;
+            node = nullptr;
+            allocator_helper()->~allocator_type();
+            return result;
+        }
+
+        void reset_helper() noexcept {
+            if(node) {
+                node_alloc_traits::destroy(*allocator_helper(), node->value());
+                node_alloc_traits::deallocate(*allocator_helper(), node, 1);
+                node = nullptr;
+                allocator_helper()->~allocator_type();
+            }
+        }
+
+        void take_from_helper(hash_map_node_handle& other) noexcept {
+            if(other.node) {
+                ::new(static_cast<void*>(&alloc_storage)) allocator_type(std::move(*other.allocator_helper()));
+                node = other.node;
+                other.node = nullptr;
+                other.allocator_helper()->~allocator_type();
+            }
+        }
+
+        using alloc_storage_type = typename std::aligned_storage<sizeof(allocator_type), alignof(allocator_type)>::type;
+
+        hash_map_node<value_type>* node;
+        alloc_storage_type alloc_storage;
+    };
+
+    /// Result of inserting a node handle into a %hash_map.
+    template<typename Iterator, typename NodeType>
+    struct hash_map_insert_return_type {
+        Iterator position;
+        bool inserted;
+        NodeType node;
+    };
+
+
+    /**
+     *  Probe policies of a %hash_map. The sequence of a policy walks the
+     *  slot groups of a table for one hash: group() is the group to read
+     *  and next() moves on. Whatever the group count, the first groups
+     *  positions of a sequence are all different, so a probe that finds no
+     *  free lane in them has seen the whole table. The maps without slot
+     *  groups run the same sequences over single slots.
+     */
+
+    /// Reads the groups after the first one in order. Neighbouring cache
+    /// lines suit the hardware prefetcher, which often wins for cheap keys.
+    struct linear_probe {
+        class sequence {
+        public:
+            sequence(const hash_map_key_hash& h, std::size_t groups) noexcept
+            : current(h.first % groups), groups(groups) {}
+
+            std::size_t group() const noexcept {
+                return current;
+            }
+
+            void next() noexcept {
+                if(++current == groups)
+                    current = 0;
+            }
+
+        private:
+            std::size_t current;
+            std::size_t groups;
+        };
+    };
+
+    /// Steps 1, 2, 3, ... groups ahead. Triangular steps cover a power of
+    /// two exactly, so the sequence runs over the smallest power of two
+    /// holding all groups and skips the positions past the last group.
+    struct triangular_probe {
+        class sequence {
+        public:
+            sequence(const hash_map_key_hash& h, std::size_t groups) noexcept
+            : current(h.first % groups), step(0), mask(0), groups(groups) {}
+
+            std::size_t group() const noexcept {
+                return current;
+            }
+
+            void next() noexcept {
+                if(mask == 0) {
+                    while(mask + 1 < groups)
+                        mask = mask * 2 + 1;
+                }
+                do {
+                    step++;
+                    current = (current + step) & mask;
+                } while(current >= groups);
+            }
+
+        private:
+            std::size_t current;
+            std::size_t step;
+            std::size_t mask;
+            std::size_t groups;
+        };
+    };
+
+    /// Steps a fixed distance taken from the second hash, so keys that
+    /// start in the same group part ways. The distance is made coprime with
+    /// the group count; it is only worked out once a probe leaves its first
+    /// group.
+    struct double_hash_probe {
+        class sequence {
+        public:
+            sequence(const hash_map_key_hash& h, std::size_t groups) noexcept
+            : current(h.first % groups), step(0), seed(h.second), groups(groups) {}
+
+            std::size_t group() const noexcept {
+                return current;
+            }
+
+            void next() noexcept {
+                if(step == 0)
+                    step = step_helper();
+                current += step;
+                if(current >= groups)
+                    current -= groups;
+            }
+
+        private:
+            std::size_t step_helper() const noexcept {
+                if(groups == 1)
+                    return 1;
+                std::size_t y = seed % (groups - 1) + 1;
+                while(gcd_helper(y, groups) != 1)
+                    y = y % (groups - 1) + 1;
+                return y;
+            }
+
+            static std::size_t gcd_helper(std::size_t a, std::size_t b) noexcept {
+                while(b != 0) {
+                    std::size_t r = a % b;
+                    a = b;
+                    b = r;
+                }
+                return a;
+            }
+
+            std::size_t current;
+            std::size_t step;
+            std::uint32_t seed;
+            std::size_t groups;
+        };
+    };
+
+
     template<typename K, typename T,
             class FirstHash = FirstKeyHash<K>,
             class SecondHash = SecondKeyHash<K>,
             typename Pred = std::equal_to<K>,
-            typename Alloc = allocator<std::pair<const K, T>*>>
+            typename Alloc = allocator<std::pair<const K, T>*>,
+            typename ProbePolicy = double_hash_probe>
     class hash_map
     {
     public:
@@ -229,115 +1148,566 @@ namespace fefu
         using iterator = hash_map_iterator<value_type*>;
         using const_iterator = hash_map_const_iterator<value_type*>;
         using size_type = std::size_t;
+        using node_allocator_type = typename std::allocator_traits<allocator_type>::template rebind_alloc<hash_map_node<value_type>>;
+        using node_type = hash_map_node_handle<key_type, mapped_type, node_allocator_type>;
+        using insert_return_type = hash_map_insert_return_type<iterator, node_type>;
+
+    private:
+        template<typename, typename, class, class, typename, typename, typename>
+        friend class hash_map;
+
+        // Alloc is rebound for the nodes and the slot groups, so every byte
+        // the %hash_map owns comes from it.
+        using alloc_traits = std::allocator_traits<allocator_type>;
+        using node_alloc_traits = std::allocator_traits<node_allocator_type>;
+        using hash_node = hash_map_node<value_type>;
+        using slot_group = typename iterator::group_type;
+        using slot_type = typename slot_group::slot_type;
+        using table_allocator_type = typename alloc_traits::template rebind_alloc<slot_group>;
+        using table_alloc_traits = std::allocator_traits<table_allocator_type>;
+
+        // Size of the first hashed table, once a map outgrows its embedded
+        // slot group.
+        static constexpr size_type HASHED_SIZE = 37;
+
+        size_type SIZE = slot_group::width;
+        size_type NOT_NULL_SIZE = 0;
+        size_type DELETED_SIZE = 0;
+        // Most groups past the first of its probe sequence that any element
+        // placed since the table was built sits. A lookup that has read
+        // MAX_PROBE + 1 groups without finding its key can stop.
+        size_type MAX_PROBE = 0;
+        float LOAD_FACTOR = 0.7;
+        size_type HUGE_PAGE_THRESHOLD = static_cast<size_type>(-1);
+        bool HUGE_PAGE_POPULATE = false;
+        table_backing BACKING = table_backing::allocator;
+        // table is table_memory rounded up to a cache line, or small_group
+        // while the map is small.
+        slot_group *table;
+        slot_group *table_memory;
+        slot_group small_group;
+        FirstHash firstHash;
+        SecondHash secondHash;
+        Pred key_equal;
+        // The rebound allocators are copies of one allocator_type, so that
+        // stateful allocators share their state between them.
+        table_allocator_type table_allocator{allocator_type()};
+        node_allocator_type node_allocator{table_allocator};
+
+        void filling_standart_value() {
+            for(size_type g = 0; g < SIZE / slot_group::width; g++) {
+                table[g].states = 0;
+                for(size_type lane = 0; lane < slot_group::width; lane++)
+                    table[g].slots[lane] = nullptr;
+            }
+        }
+
+        bool small_helper() const noexcept {
+            return table == &small_group;
+        }
+
+        // Small maps keep up to slot_group::width elements in small_group
+        // and search them by a scan of its lanes, so they allocate no
+        // table. Small mode has no probe sequences and no tombstones.
+        void make_small_helper() noexcept {
+            small_group.states = 0;
+            for(size_type lane = 0; lane < slot_group::width; lane++)
+                small_group.slots[lane] = nullptr;
+            table = &small_group;
+            table_memory = nullptr;
+            SIZE = slot_group::width;
+            MAX_PROBE = 0;
+            BACKING = table_backing::embedded;
+        }
+
+        slot_type& slot_helper(size_type x) noexcept {
+            return table[x / slot_group::width].slots[x % slot_group::width];
+        }
+
+        const slot_type& slot_helper(size_type x) const noexcept {
+            return table[x / slot_group::width].slots[x % slot_group::width];
+        }
+
+        slot_state state_helper(size_type x) const noexcept {
+            return table[x / slot_group::width].state(x % slot_group::width);
+        }
+
+        void set_state_helper(size_type x, slot_state state) noexcept {
+            table[x / slot_group::width].set_state(x % slot_group::width, state);
+        }
+
+        // Calls f(x) for every slot x of groups holding an element, skipping
+        // free lanes through the group state words.
+        template<typename F>
+        static void for_each_element_helper(const slot_group* groups, size_type n, F f) {
+            for(size_type g = 0; g < n / slot_group::width; g++) {
+                for(std::uint64_t mask = groups[g].occupied(); mask; mask &= mask - 1)
+                    f(g * slot_group::width + slot_group::first_lane(mask));
+            }
+        }
+
+        template<typename... Args>
+        hash_node* create_node_helper(Args&&... args) {
+            hash_node* node = node_alloc_traits::allocate(node_allocator, 1);
+            try {
+                node_alloc_traits::construct(node_allocator, node->value(), std::forward<Args>(args)...);
+            } catch(...) {
+                node_alloc_traits::deallocate(node_allocator, node, 1);
+                throw;
+            }
+            return node;
+        }
+
+        void destroy_node_helper(hash_node* node) {
+            node_alloc_traits::destroy(node_allocator, node->value());
+            node_alloc_traits::deallocate(node_allocator, node, 1);
+        }
+
+        void destroy_nodes_helper() {
+            if(table == nullptr)
+                return;
+            if(is_monotonic_allocator<node_allocator_type>::value) {
+                // The memory goes back with the arena, so only non-trivial
+                // elements need a visit.
+                if(!std::is_trivially_destructible<value_type>::value) {
+                    for_each_element_helper(table, SIZE, [this](size_type x) {
+                        node_alloc_traits::destroy(node_allocator, slot_helper(x)->value());
+                    });
+                }
+                return;
+            }
+            if(release_nodes_helper(is_bulk_releasable<node_allocator_type>()))
+                return;
+            for_each_element_helper(table, SIZE, [this](size_type x) {
+                destroy_node_helper(slot_helper(x));
+            });
+        }
+
+        bool release_nodes_helper(std::false_type) {
+            return false;
+        }
+
+        // When every node the allocator handed out is in this table, the
+        // nodes are destroyed and their memory is dropped in bulk.
+        bool release_nodes_helper(std::true_type) {
+            if(node_allocator.allocated() != NOT_NULL_SIZE)
+                return false;
+            if(!std::is_trivially_destructible<value_type>::value) {
+                for_each_element_helper(table, SIZE, [this](size_type x) {
+                    node_alloc_traits::destroy(node_allocator, slot_helper(x)->value());
+                });
+            }
+            node_allocator.release();
+            return true;
+        }
+
+        static size_type table_bytes_helper(size_type n) noexcept {
+            return n / slot_group::width * sizeof(slot_group);
+        }
+
+        // Up to one group of slots the map stays small. Larger slot counts
+        // are rounded up to whole groups. Tables of at least
+        // HUGE_PAGE_THRESHOLD bytes are mapped directly; the mapping is page
+        // aligned and comes zero filled, so it does not need to be touched
+        // here. Otherwise one spare group is allocated so that the groups
+        // can start on a cache line boundary.
+        void allocate_table_helper(size_type n) {
+            if(n <= slot_group::width) {
+                make_small_helper();
+                return;
+            }
+            SIZE = (n + slot_group::width - 1) / slot_group::width * slot_group::width;
+            MAX_PROBE = 0;
+            if(table_bytes_helper(SIZE) >= HUGE_PAGE_THRESHOLD) {
+                void* region = huge_page_region::map(table_bytes_helper(SIZE), HUGE_PAGE_POPULATE, BACKING);
+                if(region) {
+                    table_memory = static_cast<slot_group*>(region);
+                    table = table_memory;
+                    return;
+                }
+            }
+            BACKING = table_backing::allocator;
+            table_memory = table_alloc_traits::allocate(table_allocator, SIZE / slot_group::width + 1);
+            std::uintptr_t address = reinterpret_cast<std::uintptr_t>(table_memory);
+            std::uintptr_t line = slot_group::line_size;
+            table = reinterpret_cast<slot_group*>((address + line - 1) / line * line);
+            filling_standart_value();
+        }
+
+        void deallocate_table_helper(slot_group* old_memory, size_type n, table_backing old_backing) {
+            if(old_memory == nullptr)
+                return;
+            if(old_backing != table_backing::allocator)
+                huge_page_region::unmap(old_memory, table_bytes_helper(n));
+            else
+                table_alloc_traits::deallocate(table_allocator, old_memory, n / slot_group::width + 1);
+        }
+
+        bool equal_allocators_helper(const hash_map& other) const {
+            return table_allocator == other.table_allocator && node_allocator == other.node_allocator;
+        }
+
+        // Clones other slot by slot. The hash functors are the same, so every
+        // element keeps its position and nothing is probed again. Tombstones
+        // are copied with the state words once every node exists.
+        void copy_elements_helper(const hash_map& other) {
+            allocate_table_helper(other.SIZE);
+            try {
+                for_each_element_helper(other.table, other.SIZE, [this, &other](size_type x) {
+                    const slot_type& slot = other.slot_helper(x);
+                    hash_node* node = create_node_helper(*slot->value());
+                    node->hash = slot->hash;
+                    slot_helper(x) = slot_type(node, slot.tag());
+                    set_state_helper(x, slot_state::full);
+                });
+            } catch(...) {
+                destroy_nodes_helper();
+                deallocate_table_helper(table_memory, SIZE, BACKING);
+                make_small_helper();
+                throw;
+            }
+            for(size_type g = 0; g < SIZE / slot_group::width; g++)
+                table[g].states = other.table[g].states;
+            NOT_NULL_SIZE = other.NOT_NULL_SIZE;
+            DELETED_SIZE = other.DELETED_SIZE;
+            MAX_PROBE = other.MAX_PROBE;
+        }
+
+        // other is left as an empty small map.
+        void steal_elements_helper(hash_map& other) noexcept {
+            if(other.small_helper()) {
+                small_group = other.small_group;
+                table = &small_group;
+            } else {
+                table = other.table;
+            }
+            table_memory = other.table_memory;
+            BACKING = other.BACKING;
+            SIZE = other.SIZE;
+            NOT_NULL_SIZE = other.NOT_NULL_SIZE;
+            DELETED_SIZE = other.DELETED_SIZE;
+            MAX_PROBE = other.MAX_PROBE;
+            other.make_small_helper();
+            other.NOT_NULL_SIZE = 0;
+            other.DELETED_SIZE = 0;
+        }
+
+        // Used when other's memory cannot be adopted because the allocators
+        // differ: every element is moved into a node of our own.
+        void move_elements_helper(hash_map& other) {
+            allocate_table_helper(other.SIZE);
+            for_each_element_helper(other.table, other.SIZE, [this, &other](size_type x) {
+                slot_type& slot = other.slot_helper(x);
+                hash_node* node = create_node_helper(std::move(*slot->value()));
+                node->hash = slot->hash;
+                slot_helper(x) = slot_type(node, slot.tag());
+            });
+            for(size_type g = 0; g < SIZE / slot_group::width; g++)
+                table[g].states = other.table[g].states;
+            NOT_NULL_SIZE = other.NOT_NULL_SIZE;
+            DELETED_SIZE = other.DELETED_SIZE;
+            MAX_PROBE = other.MAX_PROBE;
+            other.clear();
+        }
+
+        iterator make_iterator(size_type x) {
+            return iterator(table, x, SIZE);
+        }
+
+        // Tombstones lengthen probe sequences just like live elements, so
+        // they count towards the load. When most of the load is tombstones
+        // the table is compacted in place instead of grown.
+        void check_load_factor() {
+            if(small_helper())
+                return;
+            if((float)(NOT_NULL_SIZE + DELETED_SIZE) / (float)SIZE >= LOAD_FACTOR) {
+                if((float)NOT_NULL_SIZE / (float)SIZE < LOAD_FACTOR / 2)
+                    drop_deleted_helper();
+                else
+                    rehash(2 * SIZE);
+            }
+        }
+
+        // The fingerprint does not depend on SIZE, so a slot keeps its tag
+        // across rehashes. It is the top of a multiplicative mix of both
+        // hashes: the low bits of h.first pick the first group, and with
+        // the default functors h.first is the key itself.
+        static std::uint16_t fingerprint_helper(const hash_map_key_hash& h) noexcept {
+            std::uint32_t mixed = (h.first ^ (h.second * 0x9E3779B1u)) * 0x85EBCA6Bu;
+            return static_cast<std::uint16_t>(mixed >> 16);
+        }
+
+        // Probe sequences run over whole slot groups: a probe reads one
+        // cache line and checks all of its lanes before ProbePolicy picks the
+        // next group.
+        size_type group_count_helper() const noexcept {
+            return SIZE / slot_group::width;
+        }
+
+        std::pair<size_type, bool> find_position_helper(const key_type& key) const {
+            return find_position_helper(key, hash_key(firstHash, secondHash, key));
+        }
+
+        // Walks the group probe sequence of key. Returns the slot holding key
+        // and true, or the first reusable slot (tombstone or empty) and
+        // false. A result of SIZE means no free slot was seen.
+        // Inserts only go past a group with no free lane, and lanes never
+        // turn empty again outside of a rebuild, so a group with an empty
+        // lane ends the search. No element sits further along its sequence
+        // than MAX_PROBE groups, so the search also ends after MAX_PROBE + 1
+        // groups, which keeps misses short in tables full of tombstones.
+        // On a miss, length receives the groups read before the free slot.
+        std::pair<size_type, bool> find_position_helper(const key_type& key, const hash_map_key_hash& h,
+                                                        size_type* length = nullptr) const {
+            if (small_helper())
+                return find_small_position_helper(key, h);
+            size_type groups = group_count_helper();
+            size_type limit = MAX_PROBE < groups ? MAX_PROBE + 1 : groups;
+            typename ProbePolicy::sequence probe(h, groups);
+            std::uint16_t tag = fingerprint_helper(h);
+            size_type free_slot = SIZE;
+            size_type free_length = 0;
+            for (size_type i = 0; i < limit; i++, probe.next()) {
+                size_type g = probe.group();
+                const slot_group& group = table[g];
+                for (std::uint64_t mask = group.occupied(); mask; mask &= mask - 1) {
+                    size_type lane = slot_group::first_lane(mask);
+                    if (group.slots[lane].has_tag(tag) && same_key_helper(group.slots[lane], key, h))
+                        return {g * slot_group::width + lane, true};
+                }
+                std::uint64_t deleted = group.match(slot_state::deleted);
+                if (deleted && free_slot == SIZE) {
+                    free_slot = g * slot_group::width + slot_group::first_lane(deleted);
+                    free_length = i;
+                }
+                std::uint64_t empty = group.match(slot_state::empty);
+                if (empty && free_slot == SIZE) {
+                    free_slot = g * slot_group::width + slot_group::first_lane(empty);
+                    free_length = i;
+                }
+                if (empty)
+                    break;
+            }
+            if (length)
+                *length = free_length;
+            return {free_slot, false};
+        }
+
+        bool same_key_helper(const hash_node* node, const key_type& key, const hash_map_key_hash& h) const {
+            return node->hash.first == h.first && node->hash.second == h.second
+                   && key_equal(node->value()->first, key);
+        }
+
+        // Small mode counterpart of find_position_helper: the occupied lanes
+        // are scanned by fingerprint, and the first empty lane is returned
+        // when key is absent.
+        std::pair<size_type, bool> find_small_position_helper(const key_type& key, const hash_map_key_hash& h) const {
+            std::uint16_t tag = fingerprint_helper(h);
+            for (std::uint64_t mask = small_group.occupied(); mask; mask &= mask - 1) {
+                size_type lane = slot_group::first_lane(mask);
+                if (small_group.slots[lane].has_tag(tag) && same_key_helper(small_group.slots[lane], key, h))
+                    return {lane, true};
+            }
+            std::uint64_t empty = small_group.match(slot_state::empty);
+            return {empty ? slot_group::first_lane(empty) : SIZE, false};
+        }
+
+        // First slot of the first group on the probe sequence of a hash that
+        // does not hold a placed element, or SIZE if there is none. Pending
+        // elements count as free. length receives the groups read before it.
+        size_type find_free_slot_helper(const hash_map_key_hash& h, size_type* length = nullptr) const {
+            if (small_helper()) {
+                std::uint64_t empty = small_group.match(slot_state::empty);
+                return empty ? slot_group::first_lane(empty) : SIZE;
+            }
+            size_type groups = group_count_helper();
+            typename ProbePolicy::sequence probe(h, groups);
+            for (size_type i = 0; i < groups; i++, probe.next()) {
+                std::uint64_t available = table[probe.group()].available();
+                if (available) {
+                    if (length)
+                        *length = i;
+                    return probe.group() * slot_group::width + slot_group::first_lane(available);
+                }
+            }
+            return SIZE;
+        }
 
-    private:
-        size_type SIZE = 37;
-        size_type NOT_NULL_SIZE = 0;
-        float LOAD_FACTOR = 0.7;
-        value_type **table;
-        bool *deleted;
-        FirstHash firstHash;
-        SecondHash secondHash;
-        Pred key_equal;
-        allocator_type table_allocator;
-        allocator<bool> deleted_allocator;
+        // Like find_position_helper, but grows the table until the probe
+        // sequence of key offers a free slot. A key missing from the first
+        // MAX_PROBE + 1 groups is absent, and any free lane further along
+        // will do. A full small map moves to a hashed table. The caller
+        // places an element at a returned free slot, so MAX_PROBE already
+        // covers it.
+        std::pair<size_type, bool> find_insert_position_helper(const key_type& key, const hash_map_key_hash& h) {
+            for (;;) {
+                size_type length = 0;
+                auto pos = find_position_helper(key, h, &length);
+                if (pos.second)
+                    return pos;
+                if (pos.first == SIZE)
+                    pos.first = find_free_slot_helper(h, &length);
+                if (pos.first != SIZE) {
+                    note_probe_length_helper(length);
+                    return pos;
+                }
+                rehash(small_helper() ? HASHED_SIZE : 2 * SIZE);
+            }
+        }
 
-        void filling_standart_value() {
-            for(int i = 0; i < SIZE; i++) {
-                table[i] = nullptr;
-                deleted[i] = false;
+        void note_probe_length_helper(size_type length) noexcept {
+            if (length > MAX_PROBE)
+                MAX_PROBE = length;
+        }
+
+        void place_node_helper(size_type x, hash_node* node, const hash_map_key_hash& h) {
+            node->hash = h;
+            place_slot_helper(x, slot_type(node, fingerprint_helper(h)));
+        }
+
+        void place_slot_helper(size_type x, slot_type slot) {
+            if(state_helper(x) == slot_state::deleted)
+                DELETED_SIZE--;
+            slot_helper(x) = slot;
+            set_state_helper(x, slot_state::full);
+            NOT_NULL_SIZE++;
+        }
+
+        // Detaches the node in slot x, leaving a tombstone behind unless the
+        // map is small.
+        hash_node* take_node_helper(size_type x) {
+            hash_node* node = slot_helper(x);
+            slot_helper(x) = nullptr;
+            NOT_NULL_SIZE--;
+            if(small_helper()) {
+                set_state_helper(x, slot_state::empty);
+            } else {
+                set_state_helper(x, slot_state::deleted);
+                DELETED_SIZE++;
+            }
+            return node;
+        }
+
+        // Removes every tombstone without reallocating the table. Elements
+        // are first marked as pending and tombstones as empty, a group word
+        // at a time. Then each element is moved to the first group of its
+        // probe sequence with a lane that is not yet final, swapping with
+        // another pending element if needed; an element already in that
+        // group stays where it is. Groups ahead of a final element on its
+        // probe sequence never get a free lane again, so every element
+        // stays reachable.
+        void drop_deleted_helper() {
+            MAX_PROBE = 0;
+            for(size_type g = 0; g < SIZE / slot_group::width; g++) {
+                std::uint64_t occupied = table[g].occupied();
+                table[g].states = occupied | (occupied << 1);
+            }
+
+            for(size_type i = 0; i < SIZE; i++) {
+                while(state_helper(i) == slot_state::pending) {
+                    size_type length = 0;
+                    size_type target = find_free_slot_helper(slot_helper(i)->hash, &length);
+                    if(target == SIZE) {
+                        // The probe sequence is saturated with placed
+                        // elements; fall back to a full relink.
+                        rehash(SIZE);
+                        return;
+                    }
+                    note_probe_length_helper(length);
+                    if(target / slot_group::width == i / slot_group::width) {
+                        set_state_helper(i, slot_state::full);
+                    } else if(state_helper(target) == slot_state::empty) {
+                        slot_helper(target) = slot_helper(i);
+                        set_state_helper(target, slot_state::full);
+                        slot_helper(i) = nullptr;
+                        set_state_helper(i, slot_state::empty);
+                    } else {
+                        std::swap(slot_helper(i), slot_helper(target));
+                        set_state_helper(target, slot_state::full);
+                    }
+                }
             }
+            DELETED_SIZE = 0;
         }
 
         template<typename Key, typename Value>
         std::pair<iterator, bool> insert_value_helper(Key&& key, Value&& value) {
-            auto x = firstHash(key, SIZE);
-            auto y = secondHash(key, SIZE);
-            for (int i = 1; i < SIZE; i++) {
-                if (table[x] == nullptr || deleted[x]) {
-                    table[x] = new value_type(key, value);
-                    deleted[x] = false;
-                    NOT_NULL_SIZE++;
-                    return {iterator(table + x, deleted, x, SIZE), true};
-                } else if (key_equal(table[x]->first, key)) {
-                    return {iterator(table + x, deleted, x, SIZE), false};
-                }
-                x = (x + i * y) % SIZE;
-            }
+            hash_map_key_hash h = hash_key(firstHash, secondHash, key);
+            auto pos = find_insert_position_helper(key, h);
+            if (pos.second)
+                return {make_iterator(pos.first), false};
+            place_node_helper(pos.first, create_node_helper(std::forward<Key>(key), std::forward<Value>(value)), h);
+            return {make_iterator(pos.first), true};
         }
 
         template<typename Key, typename Value>
         std::pair<iterator, bool> insert_or_assign_value_helper(Key&& key, Value&& value) {
-            auto x = firstHash(key, SIZE);
-            auto y = secondHash(key, SIZE);
-            for (int i = 1; i < SIZE; i++) {
-                if (table[x] == nullptr || deleted[x]) {
-                    table[x] = new value_type(key, value);
-                    deleted[x] = false;
-                    NOT_NULL_SIZE++;
-                    return {iterator(table + x, deleted, x, SIZE), true};
-                } else if (key_equal(table[x]->first, key)) {
-                    table[x]->second = value;
-                    return { iterator(table + x, deleted, x, SIZE), false};
-                }
-                x = (x + i * y) % SIZE;
+            hash_map_key_hash h = hash_key(firstHash, secondHash, key);
+            auto pos = find_insert_position_helper(key, h);
+            if (pos.second) {
+                slot_helper(pos.first)->value()->second = std::forward<Value>(value);
+                return {make_iterator(pos.first), false};
             }
+            place_node_helper(pos.first, create_node_helper(std::forward<Key>(key), std::forward<Value>(value)), h);
+            return {make_iterator(pos.first), true};
+        }
+
+        // The mapped value is only constructed, in place, when key is absent.
+        template<typename Key, typename... Args>
+        std::pair<iterator, bool> try_emplace_helper(Key&& key, Args&&... args) {
+            check_load_factor();
+            hash_map_key_hash h = hash_key(firstHash, secondHash, key);
+            auto pos = find_insert_position_helper(key, h);
+            if (pos.second)
+                return {make_iterator(pos.first), false};
+            place_node_helper(pos.first, create_node_helper(std::piecewise_construct,
+                                                        std::forward_as_tuple(std::forward<Key>(key)),
+                                                        std::forward_as_tuple(std::forward<Args>(args)...)), h);
+            return {make_iterator(pos.first), true};
+        }
+
+        template<typename Key, typename Value, typename Combine>
+        bool upsert_helper(Key&& key, Value&& value, Combine& combine) {
+            check_load_factor();
+            hash_map_key_hash h = hash_key(firstHash, secondHash, key);
+            auto pos = find_insert_position_helper(key, h);
+            if (pos.second) {
+                combine(slot_helper(pos.first)->value()->second, std::forward<Value>(value));
+                return false;
+            }
+            place_node_helper(pos.first, create_node_helper(std::forward<Key>(key), std::forward<Value>(value)), h);
+            return true;
         }
 
         iterator find_value_helper(const key_type& key) {
-            auto x = firstHash(key, SIZE);
-            auto y = secondHash(key, SIZE);
-            for (int i = 1; i < SIZE; i++) {
-                if (table[x] != nullptr) {
-                    if (key_equal(table[x]->first, key) && !deleted[x])
-                        return iterator(table + x, deleted, x, SIZE);
-                } else {
-                    return end();
-                }
-                x = (x + i * y) % SIZE;
-            }
+            auto pos = find_position_helper(key);
+            if (pos.second)
+                return make_iterator(pos.first);
             return end();
         }
 
         template<typename Key>
         mapped_type& operator_helper(Key&& key) {
-            if(contains(key))
-                return (*find(key))->second;
-            else
-                return (*insert({key, 0}).first)->second;
+            return (*try_emplace_helper(std::forward<Key>(key)).first)->second;
         }
 
     public:
-        /// Default constructor.
+        /// Default constructor. Allocates nothing until the map outgrows
+        /// its embedded slot group.
         hash_map() {
-            table = table_allocator.allocate(SIZE);
-            deleted = deleted_allocator.allocate(SIZE);
-            for(int i = 0; i < SIZE; i++) {
-                table[i] = nullptr;
-                deleted[i] = false;
-            }
+            make_small_helper();
         }
 
         ~hash_map() {
-            for (int i = 0; i < SIZE; i++)
-                if(table) {
-                    if (table[i])
-                        delete table[i];
-                }
-            if(table)
-                table_allocator.deallocate(table,SIZE);
-            if(deleted)
-                deleted_allocator.deallocate(deleted, SIZE);
+            destroy_nodes_helper();
+            deallocate_table_helper(table_memory, SIZE, BACKING);
         }
         /**
          *  @brief  Default constructor creates no elements.
          *  @param n  Minimal initial number of buckets.
          */
         explicit hash_map(size_type n) {
-            SIZE = n;
-            table = table_allocator.allocate(SIZE);
-            deleted = deleted_allocator.allocate(SIZE);
-            filling_standart_value();
+            allocate_table_helper(n);
         }
 
         /**
@@ -353,10 +1723,7 @@ namespace fefu
         template<typename InputIterator>
         hash_map(InputIterator first, InputIterator last,
                  size_type n = 0) {
-            SIZE = n;
-            table = table_allocator.allocate(SIZE);
-            deleted = deleted_allocator.allocate(SIZE);
-            filling_standart_value();
+            allocate_table_helper(n);
 
             for(auto it = first; it != last; it++) {
                 insert({(*it)->key, (*it)->value});
@@ -364,41 +1731,29 @@ namespace fefu
         }
 
         /// Copy constructor.
-        hash_map(const hash_map& other) {
-            SIZE = other.SIZE;
-            NOT_NULL_SIZE = other.NOT_NULL_SIZE;
-            table = table_allocator.allocate(SIZE);
-            filling_standart_value();
-
-            for(int i = 0; i < other.SIZE; i++) {
-                if(table[i])
-                    insert({table[i]->first, table[i]->second});
-                deleted[i] = other.deleted[i];
-            }
-
-            firstHash = other.firstHash;
-            secondHash = other.secondHash;
-            key_equal = other.key_equal;
+        hash_map(const hash_map& other): LOAD_FACTOR(other.LOAD_FACTOR),
+        HUGE_PAGE_THRESHOLD(other.HUGE_PAGE_THRESHOLD), HUGE_PAGE_POPULATE(other.HUGE_PAGE_POPULATE),
+        firstHash(other.firstHash), secondHash(other.secondHash), key_equal(other.key_equal),
+        table_allocator(table_alloc_traits::select_on_container_copy_construction(other.table_allocator)),
+        node_allocator(table_allocator) {
+            copy_elements_helper(other);
         }
 
         /// Move constructor.
-        hash_map(hash_map&& other): table(std::move(other.table)), deleted(std::move(other.deleted)),
+        hash_map(hash_map&& other): LOAD_FACTOR(other.LOAD_FACTOR),
+        HUGE_PAGE_THRESHOLD(other.HUGE_PAGE_THRESHOLD), HUGE_PAGE_POPULATE(other.HUGE_PAGE_POPULATE),
         firstHash(std::move(other.firstHash)), secondHash(std::move(other.secondHash)),
-        key_equal(std::move(other.key_equal)), SIZE(other.SIZE), NOT_NULL_SIZE(other.NOT_NULL_SIZE),
-        table_allocator(std::move(other.table_allocator)), deleted_allocator(std::move(other.deleted_allocator)){
-            other.table = nullptr;
-            other.deleted = nullptr;
+        key_equal(std::move(other.key_equal)), table_allocator(std::move(other.table_allocator)),
+        node_allocator(std::move(other.node_allocator)) {
+            steal_elements_helper(other);
         }
 
         /**
          *  @brief Creates an %hash_map with no elements.
          *  @param a An allocator object.
          */
-        explicit hash_map(const allocator_type& a) {
-            table_allocator = a;
-            table = table_allocator.allocate(SIZE);
-            deleted = deleted_allocator.allocate(SIZE);
-            filling_standart_value();
+        explicit hash_map(const allocator_type& a): table_allocator(a), node_allocator(a) {
+            make_small_helper();
         }
 
         /*
@@ -407,36 +1762,30 @@ namespace fefu
         * @param  a  An allocator object.
         */
         hash_map(const hash_map& other,
-                 const allocator_type& a) {
-            table_allocator = a;
-            SIZE = other.SIZE;
-            NOT_NULL_SIZE = other.NOT_NULL_SIZE;
-            table = table_allocator.allocate(SIZE);
-            deleted = deleted_allocator.allocate(SIZE);
-            filling_standart_value();
-
-            for(int i = 0; i < other.SIZE; i++) {
-                if(table[i])
-                    insert({table[i]->first, table[i]->second});
-                deleted[i] = other.deleted[i];
-            }
-
-            firstHash = other.firstHash;
-            secondHash = other.secondHash;
-            key_equal = other.key_equal;
+                 const allocator_type& a): LOAD_FACTOR(other.LOAD_FACTOR),
+        HUGE_PAGE_THRESHOLD(other.HUGE_PAGE_THRESHOLD), HUGE_PAGE_POPULATE(other.HUGE_PAGE_POPULATE),
+        firstHash(other.firstHash), secondHash(other.secondHash), key_equal(other.key_equal),
+        table_allocator(a), node_allocator(a) {
+            copy_elements_helper(other);
         }
 
         /*
         *  @brief  Move constructor with allocator argument.
         *  @param  uset Input %hash_map to move.
         *  @param  a    An allocator object.
+        *
+        *  The memory of @a other is adopted only if its allocators compare
+        *  equal to @a a; otherwise its elements are moved one by one.
         */
         hash_map(hash_map&& other,
-                 const allocator_type& a) : table(std::move(other.table)), deleted(std::move(other.deleted)),
+                 const allocator_type& a): LOAD_FACTOR(other.LOAD_FACTOR),
+        HUGE_PAGE_THRESHOLD(other.HUGE_PAGE_THRESHOLD), HUGE_PAGE_POPULATE(other.HUGE_PAGE_POPULATE),
         firstHash(std::move(other.firstHash)), secondHash(std::move(other.secondHash)),
-        key_equal(std::move(other.key_equal)), SIZE(other.SIZE), NOT_NULL_SIZE(other.NOT_NULL_SIZE), table_allocator(a){
-            table = nullptr;
-            deleted = nullptr;
+        key_equal(std::move(other.key_equal)), table_allocator(a), node_allocator(a) {
+            if(equal_allocators_helper(other))
+                steal_elements_helper(other);
+            else
+                move_elements_helper(other);
         }
 
         /**
@@ -449,10 +1798,7 @@ namespace fefu
          */
         hash_map(std::initializer_list<value_type> l,
                  size_type n = 0) {
-            SIZE = n;
-            table = table_allocator.allocate(SIZE);
-            deleted = deleted_allocator.allocate(SIZE);
-            filling_standart_value();
+            allocate_table_helper(n);
 
             for(int i = 0; i < l.size(); i++)
                 insert({l[i].first, l[i].second});
@@ -460,40 +1806,55 @@ namespace fefu
 
         /// Copy assignment operator.
         hash_map& operator=(const hash_map& other) {
-            SIZE = other.SIZE;
-            NOT_NULL_SIZE = other.NOT_NULL_SIZE;
-            table = table_allocator.allocate(SIZE);
-            deleted = deleted_allocator.allocate(SIZE);
-            filling_standart_value();
+            if(this == &other)
+                return *this;
 
-            for(int i = 0; i < other.SIZE; i++) {
-                if(table[i])
-                    insert({table[i]->first, table[i]->second});
-                deleted[i] = other.deleted[i];
-            }
+            destroy_nodes_helper();
+            deallocate_table_helper(table_memory, SIZE, BACKING);
+            table = nullptr;
+            table_memory = nullptr;
 
+            if(alloc_traits::propagate_on_container_copy_assignment::value) {
+                table_allocator = other.table_allocator;
+                node_allocator = other.node_allocator;
+            }
             firstHash = other.firstHash;
             secondHash = other.secondHash;
             key_equal = other.key_equal;
+            LOAD_FACTOR = other.LOAD_FACTOR;
+            HUGE_PAGE_THRESHOLD = other.HUGE_PAGE_THRESHOLD;
+            HUGE_PAGE_POPULATE = other.HUGE_PAGE_POPULATE;
 
+            copy_elements_helper(other);
             return *this;
         }
 
         /// Move assignment operator.
         hash_map& operator=(hash_map&& other) {
-            table = std::move(other.table);
-            deleted = std::move(other.deleted);
+            if(this == &other)
+                return *this;
+
+            destroy_nodes_helper();
+            deallocate_table_helper(table_memory, SIZE, BACKING);
+            table = nullptr;
+            table_memory = nullptr;
+
             firstHash = std::move(other.firstHash);
             secondHash = std::move(other.secondHash);
             key_equal = std::move(other.key_equal);
-            table_allocator = std::move(other.table_allocator);
-            deleted_allocator = std::move(other.deleted_allocator);
-
-            SIZE = other.SIZE;
-            NOT_NULL_SIZE = other.NOT_NULL_SIZE;
-
-            table = nullptr;
-            deleted = nullptr;
+            LOAD_FACTOR = other.LOAD_FACTOR;
+            HUGE_PAGE_THRESHOLD = other.HUGE_PAGE_THRESHOLD;
+            HUGE_PAGE_POPULATE = other.HUGE_PAGE_POPULATE;
+
+            if(alloc_traits::propagate_on_container_move_assignment::value) {
+                table_allocator = std::move(other.table_allocator);
+                node_allocator = std::move(other.node_allocator);
+                steal_elements_helper(other);
+            } else if(equal_allocators_helper(other)) {
+                steal_elements_helper(other);
+            } else {
+                move_elements_helper(other);
+            }
 
             return *this;
         }
@@ -517,7 +1878,7 @@ namespace fefu
 
         ///  Returns the allocator object used by the %hash_map.
         allocator_type get_allocator() const noexcept {
-            return table_allocator;
+            return allocator_type(table_allocator);
         }
 
         // size and capacity:
@@ -544,12 +1905,9 @@ namespace fefu
          *  %hash_map.
          */
         iterator begin() noexcept {
-            for(int i = 0; i < SIZE; i++) {
-                if(table[i] != nullptr && deleted[i] == false) {
-                    return iterator(table + i, deleted, i, SIZE);
-                }
-            }
-            return end();
+            iterator it(table, 0, SIZE);
+            it.seek_helper();
+            return it;
         }
 
         //@{
@@ -562,11 +1920,9 @@ namespace fefu
         }
 
         const_iterator cbegin() const noexcept {
-            for(int i = 0; i < SIZE; i++) {
-                if(table[i] != nullptr && deleted[i] == false)
-                    return const_iterator(table + i, deleted, i, SIZE);
-            }
-            return cend();
+            const_iterator it(table, 0, SIZE);
+            it.seek_helper();
+            return it;
         }
 
         /**
@@ -574,7 +1930,7 @@ namespace fefu
          *  the %hash_map.
          */
         iterator end() noexcept {
-            return iterator(table + SIZE, deleted, SIZE, SIZE);
+            return iterator(table, SIZE, SIZE);
         }
 
         //@{
@@ -587,7 +1943,7 @@ namespace fefu
         }
 
         const_iterator cend() const noexcept {
-            return const_iterator(table + SIZE, deleted, SIZE, SIZE);
+            return const_iterator(table, SIZE, SIZE);
         }
         //@}
 
@@ -615,7 +1971,16 @@ namespace fefu
         */
         template<typename... _Args>
         std::pair<iterator, bool> emplace(_Args&&... args) {
-            return insert(value_type(std::forward<_Args>(args)...));
+            hash_node* node = create_node_helper(std::forward<_Args>(args)...);
+            check_load_factor();
+            hash_map_key_hash h = hash_key(firstHash, secondHash, node->value()->first);
+            auto pos = find_insert_position_helper(node->value()->first, h);
+            if (pos.second) {
+                destroy_node_helper(node);
+                return {make_iterator(pos.first), false};
+            }
+            place_node_helper(pos.first, node, h);
+            return {make_iterator(pos.first), true};
         }
 
         /**
@@ -642,13 +2007,13 @@ namespace fefu
          */
         template <typename... _Args>
         std::pair<iterator, bool> try_emplace(const key_type& k, _Args&&... args){
-            return insert(value_type(std::piecewise_construct, std::forward_as_tuple(k), std::forward_as_tuple(std::forward<_Args>(args)...)));
+            return try_emplace_helper(k, std::forward<_Args>(args)...);
         }
 
         // move-capable overload
         template <typename... _Args>
         std::pair<iterator, bool> try_emplace(key_type&& k, _Args&&... args) {
-            return insert(value_type(std::piecewise_construct, std::forward_as_tuple(std::move(k)), std::forward_as_tuple(std::forward<_Args>(args)...)));
+            return try_emplace_helper(std::move(k), std::forward<_Args>(args)...);
         }
 
         //@{
@@ -670,23 +2035,50 @@ namespace fefu
         */
 
         std::pair<iterator, bool> insert(const value_type& value)  {
-            if(SIZE == 0)
-                rehash(32);
-            if(NOT_NULL_SIZE / SIZE >= LOAD_FACTOR)
-                rehash(2 * SIZE);
-
+            check_load_factor();
             return insert_value_helper(value.first, value.second);
         }
 
         std::pair<iterator, bool> insert(value_type&& value) {
-            if(SIZE == 0)
-                rehash(32);
-            if((float)NOT_NULL_SIZE / (float)SIZE >= LOAD_FACTOR)
-                rehash(2 * SIZE);
-
+            check_load_factor();
             return insert_value_helper(std::move(value.first), std::move(value.second));
         }
 
+        /**
+         *  @brief Attempts to insert an extracted node into the %hash_map.
+         *  @param nh  A node handle obtained from extract().
+         *
+         *  @return  An insert_return_type whose position points to the element
+         *           with the node's key, whose inserted flag is true if the node
+         *           was linked in, and whose node holds @a nh back if an
+         *           element with the same key was already present.
+         *
+         *  The node is linked into the table as is: no element is allocated,
+         *  copied or moved.
+         */
+        insert_return_type insert(node_type&& nh) {
+            if(nh.empty())
+                return {end(), false, node_type()};
+
+            check_load_factor();
+            // The node may come from a map with other hash functors, so its
+            // key is hashed again.
+            hash_map_key_hash h = hash_key(firstHash, secondHash, nh.key());
+            auto pos = find_insert_position_helper(nh.key(), h);
+            if(pos.second)
+                return {make_iterator(pos.first), false, std::move(nh)};
+
+            if(*nh.allocator_helper() == node_allocator) {
+                place_node_helper(pos.first, nh.release(), h);
+            } else {
+                // The node cannot be freed by our allocator later on, so its
+                // element is moved into a node of our own.
+                place_node_helper(pos.first, create_node_helper(nh.key(), std::move(nh.mapped())), h);
+                nh = node_type();
+            }
+            return {make_iterator(pos.first), true, node_type()};
+        }
+
         //@}
 
         /**
@@ -741,23 +2133,58 @@ namespace fefu
 
         template <typename _Obj>
         std::pair<iterator, bool> insert_or_assign(const key_type& key, _Obj&& obj) {
-            if(SIZE == 0)
-                rehash(32);
-            if(NOT_NULL_SIZE / SIZE >= LOAD_FACTOR)
-                rehash(2 * SIZE);
-
-            return insert_or_assign_value_helper(key, obj);
+            check_load_factor();
+            return insert_or_assign_value_helper(key, std::forward<_Obj>(obj));
         }
 
         // move-capable overload
         template <typename _Obj>
         std::pair<iterator, bool> insert_or_assign(key_type&& key, _Obj&& obj) {
-            if(SIZE == 0)
-                rehash(32);
-            if(NOT_NULL_SIZE / SIZE >= LOAD_FACTOR)
-                rehash(2 * SIZE);
+            check_load_factor();
+            return insert_or_assign_value_helper(std::move(key), std::forward<_Obj>(obj));
+        }
+
+        //@{
+        /**
+         *  @brief Updates the element with the given key or inserts a new one.
+         *  @param key      Key of the element to update or insert.
+         *  @param value    Value to insert, or to combine with the mapped value
+         *                  already present.
+         *  @param combine  Functor called as combine(mapped, value) when @a key
+         *                  is present; it updates mapped in place.
+         *  @return  True if a new element was inserted.
+         *
+         *  The key is looked up only once and the existing mapped value is
+         *  neither copied nor reassigned, e.g.
+         *  upsert(k, 1, [](int& count, int one) { count += one; }).
+         */
+        template <typename _Obj, typename _Combine>
+        bool upsert(const key_type& key, _Obj&& value, _Combine combine) {
+            return upsert_helper(key, std::forward<_Obj>(value), combine);
+        }
+
+        // move-capable overload
+        template <typename _Obj, typename _Combine>
+        bool upsert(key_type&& key, _Obj&& value, _Combine combine) {
+            return upsert_helper(std::move(key), std::forward<_Obj>(value), combine);
+        }
+        //@}
 
-            return insert_or_assign_value_helper(std::move(key), std::move(obj));
+        /**
+         *  @brief Runs a functor on the mapped value of the given key.
+         *  @param key  Key of the element to modify.
+         *  @param fn   Functor called as fn(mapped) if @a key is present.
+         *  @return  True if @a key was present and @a fn was called.
+         *
+         *  Nothing is inserted when @a key is absent.
+         */
+        template <typename _Fn>
+        bool modify(const key_type& key, _Fn fn) {
+            auto pos = find_position_helper(key);
+            if (!pos.second)
+                return false;
+            fn(slot_helper(pos.first)->value()->second);
+            return true;
         }
 
         //@{
@@ -775,16 +2202,16 @@ namespace fefu
          *  any way.  Managing the pointer is the user's responsibility.
          */
         iterator erase(const_iterator position) {
-            auto key = (*position)->first;
-            erase(key);
-            return position;
+            size_type x = position.cur_index;
+            destroy_node_helper(take_node_helper(x));
+            return ++make_iterator(x);
         }
 
         // LWG 2059.
         iterator erase(iterator position) {
-            auto key = (*position)->first;
-            erase(key);
-            return position;
+            size_type x = position.cur_index;
+            destroy_node_helper(take_node_helper(x));
+            return ++make_iterator(x);
         }
         //@}
 
@@ -801,21 +2228,11 @@ namespace fefu
          *  any way.  Managing the pointer is the user's responsibility.
          */
         size_type erase(const key_type& key) {
-            auto x = firstHash(key, SIZE);
-            auto y = secondHash(key, SIZE);
-            for (int i = 1; i < SIZE; i++) {
-                if (table[x] != nullptr) {
-                    if (key_equal(table[x]->first, key) && !deleted[x]) {
-                        deleted[x] = true;
-                        NOT_NULL_SIZE--;
-                        return 1;
-                    }
-                } else {
-                    return 0;
-                }
-                x = (x + i * y) % SIZE;
-            }
-            return 0;
+            auto pos = find_position_helper(key);
+            if (!pos.second)
+                return 0;
+            destroy_node_helper(take_node_helper(pos.first));
+            return 1;
         }
 
         /**
@@ -833,12 +2250,51 @@ namespace fefu
          *  in any way.  Managing the pointer is the user's responsibility.
          */
         iterator erase(const_iterator first, const_iterator last) {
-            for(const_iterator it = first; it != last; it) {
-                erase(it);
+            size_type from = first.cur_index;
+            size_type to = last.cur_index;
+            for(size_type x = from; x < to; x++) {
+                if(state_helper(x) == slot_state::full)
+                    destroy_node_helper(take_node_helper(x));
             }
 
-            return last;
+            return make_iterator(to);
+        }
+
+        template<typename K2, typename T2, class FirstHash2, class SecondHash2,
+                typename Pred2, typename Alloc2, typename ProbePolicy2, typename Predicate>
+        friend typename hash_map<K2, T2, FirstHash2, SecondHash2, Pred2, Alloc2, ProbePolicy2>::size_type
+        erase_if(hash_map<K2, T2, FirstHash2, SecondHash2, Pred2, Alloc2, ProbePolicy2>& map, Predicate pred);
+
+        //@{
+        /**
+         *  @brief Detaches an element from the %hash_map.
+         *  @param  position  An iterator pointing to the element to extract.
+         *  @return A node handle owning the element.
+         *
+         *  The element is unlinked from the table without being copied or
+         *  freed, so it can be inserted into another %hash_map.
+         */
+        node_type extract(const_iterator position) {
+            return node_type(take_node_helper(position.cur_index), node_allocator);
+        }
+
+        node_type extract(iterator position) {
+            return node_type(take_node_helper(position.cur_index), node_allocator);
+        }
+
+        /**
+         *  @brief Detaches the element with the given key from the %hash_map.
+         *  @param  key  Key of the element to extract.
+         *  @return A node handle owning the element, or an empty node handle
+         *          if @a key is not present.
+         */
+        node_type extract(const key_type& key) {
+            auto pos = find_position_helper(key);
+            if (!pos.second)
+                return node_type();
+            return node_type(take_node_helper(pos.first), node_allocator);
         }
+        //@}
 
         /**
          *  Erases all elements in an %hash_map.
@@ -847,20 +2303,12 @@ namespace fefu
          *  in any way.  Managing the pointer is the user's responsibility.
          */
         void clear() noexcept {
-            for (int i = 0; i < SIZE; i++)
-                if (table[i])
-                    delete table[i];
-            table_allocator.deallocate(table,SIZE);
-            deleted_allocator.deallocate(deleted, SIZE);
+            destroy_nodes_helper();
+            deallocate_table_helper(table_memory, SIZE, BACKING);
 
-            SIZE = 37;
             NOT_NULL_SIZE = 0;
-            table = table_allocator.allocate(SIZE);
-            deleted = deleted_allocator.allocate(SIZE);
-            for(int i = 0; i < SIZE; i++) {
-                table[i] = nullptr;
-                deleted[i] = false;
-            }
+            DELETED_SIZE = 0;
+            make_small_helper();
         }
 
         /**
@@ -874,41 +2322,82 @@ namespace fefu
          *  std::swap(m1,m2) will feed to this function.
          */
         void swap(hash_map& x){
+            if(alloc_traits::propagate_on_container_swap::value) {
+                std::swap(table_allocator, x.table_allocator);
+                std::swap(node_allocator, x.node_allocator);
+            }
+            std::swap(firstHash, x.firstHash);
+            std::swap(secondHash, x.secondHash);
+            std::swap(key_equal, x.key_equal);
+            // An embedded slot group cannot change hands, so its contents
+            // are swapped and the table pointers fixed up.
+            bool small = small_helper();
+            bool x_small = x.small_helper();
+            std::swap(small_group, x.small_group);
             std::swap(table, x.table);
-            std::swap(deleted, x.deleted);
+            std::swap(table_memory, x.table_memory);
+            if(x_small)
+                table = &small_group;
+            if(small)
+                x.table = &x.small_group;
             std::swap(SIZE, x.SIZE);
             std::swap(NOT_NULL_SIZE, x.NOT_NULL_SIZE);
+            std::swap(DELETED_SIZE, x.DELETED_SIZE);
+            std::swap(MAX_PROBE, x.MAX_PROBE);
             std::swap(LOAD_FACTOR, x.LOAD_FACTOR);
+            std::swap(HUGE_PAGE_THRESHOLD, x.HUGE_PAGE_THRESHOLD);
+            std::swap(HUGE_PAGE_POPULATE, x.HUGE_PAGE_POPULATE);
+            std::swap(BACKING, x.BACKING);
         }
 
+        /**
+         *  @brief  Moves the elements of @a source that are not yet present
+         *          into the %hash_map.
+         *  @param  source  An %hash_map with the same key and mapped types.
+         *
+         *  When both node allocators compare equal, nodes are relinked from
+         *  @a source rather than copied, so no element is allocated, copied
+         *  or freed; otherwise each element is moved into a new node. Elements whose key already
+         *  exists in the %hash_map stay in @a source. The table is grown at
+         *  most once, up front, for the size of the union.
+         */
         template<class FirstHash2 = FirstKeyHash<K>,
                 class SecondHash2 = SecondKeyHash<K>,
                 typename Pred2 = std::equal_to<K>,
-                typename Alloc2 = allocator_type>
-        void merge(hash_map<K, T, FirstHash2, SecondHash2, Pred2, Alloc>& source) {
-            if(source.max_size() > SIZE)
-                rehash(source.max_size());
-
-            for(int i = 0; i < source.max_size(); i++) {
-                if(source.table[i]) {
-                    insert({source.table[i]->first, source.table[i]->second});
+                typename Alloc2 = allocator_type,
+                typename ProbePolicy2 = ProbePolicy>
+        void merge(hash_map<K, T, FirstHash2, SecondHash2, Pred2, Alloc, ProbePolicy2>& source) {
+            if(source.NOT_NULL_SIZE == 0 || static_cast<const void*>(&source) == this)
+                return;
+
+            // Tombstones count against the load factor as in
+            // check_load_factor(); the rehash drops them.
+            size_type needed = (size_type)((float)(NOT_NULL_SIZE + source.NOT_NULL_SIZE) / LOAD_FACTOR) + 1;
+            if(needed > SIZE || (float)(NOT_NULL_SIZE + DELETED_SIZE + source.NOT_NULL_SIZE) / (float)SIZE >= LOAD_FACTOR)
+                rehash(needed);
+
+            source.for_each_element_helper(source.table, source.SIZE, [this, &source](size_type i) {
+                value_type* element = source.slot_helper(i)->value();
+                hash_map_key_hash h = hash_key(firstHash, secondHash, element->first);
+                auto pos = find_insert_position_helper(element->first, h);
+                if(pos.second)
+                    return;
+                if(node_allocator == source.node_allocator) {
+                    place_node_helper(pos.first, source.take_node_helper(i), h);
+                } else {
+                    place_node_helper(pos.first, create_node_helper(element->first, std::move(element->second)), h);
+                    source.destroy_node_helper(source.take_node_helper(i));
                 }
-            }
+            });
         }
 
         template<class FirstHash2 = FirstKeyHash<K>,
                 class SecondHash2 = SecondKeyHash<K>,
                 typename Pred2 = std::equal_to<K>,
-                typename Alloc2 = allocator_type>
-        void merge(hash_map<K, T, FirstHash2, SecondHash2, Pred2, Alloc>&& source) {
-            if(source.max_size() > SIZE)
-                rehash(source.max_size());
-
-            for(int i = 0; i < source.max_size(); i++) {
-                if(source.table[i]) {
-                    insert({source.table[i]->first, std::move(source.table[i]->second)});
-                }
-            }
+                typename Alloc2 = allocator_type,
+                typename ProbePolicy2 = ProbePolicy>
+        void merge(hash_map<K, T, FirstHash2, SecondHash2, Pred2, Alloc, ProbePolicy2>&& source) {
+            merge(source);
         }
 
         // observers.
@@ -974,18 +2463,7 @@ namespace fefu
          *  @return  True if there is any element with the specified key.
          */
         bool contains(const key_type& key) const {
-            auto x = firstHash(key, SIZE);
-            auto y = secondHash(key, SIZE);
-            for (int i = 1; i < SIZE; i++) {
-                if (table[x] != nullptr) {
-                    if (key_equal(table[x]->first, key) && !deleted[x])
-                        return true;
-                } else {
-                    return false;
-                }
-                x = (x + i * y) % SIZE;
-            }
-            return false;
+            return find_position_helper(key).second;
         }
 
         //@{
@@ -1045,7 +2523,7 @@ namespace fefu
         */
         size_type bucket(const key_type& _K) const {
             if(contains(_K)) {
-                return find(_K).operator->() - begin().operator->();
+                return find(_K).cur_index - begin().cur_index;
             } else
                 return 0;
         }
@@ -1054,7 +2532,7 @@ namespace fefu
 
         /// Returns the average number of elements per bucket.
         float load_factor() const noexcept {
-            return NOT_NULL_SIZE / SIZE;
+            return SIZE == 0 ? 0 : (float)NOT_NULL_SIZE / (float)SIZE;
         }
 
         /// Returns a positive number that the %hash_map tries to keep the
@@ -1071,6 +2549,66 @@ namespace fefu
             LOAD_FACTOR = z;
         }
 
+        /// Returns the most groups past the first of its probe sequence
+        /// that an element sits at since the table was last rebuilt.
+        /// Missed lookups read at most one group more than this.
+        size_type max_probe_length() const noexcept {
+            return MAX_PROBE;
+        }
+
+        /**
+         *  @brief  Sets the table size from which slots are mapped with huge pages.
+         *  @param  bytes     Minimal size of the slot groups
+         *                    for them to be mmap'ed and advised MADV_HUGEPAGE.
+         *                    The default disables huge pages.
+         *  @param  populate  Whether to pre-fault the mapping when it is made,
+         *                    trading allocation time for predictable warmup.
+         *
+         *  Takes effect the next time the table is allocated, e.g. on rehash.
+         */
+        void huge_page_threshold(size_type bytes, bool populate = false) {
+            HUGE_PAGE_THRESHOLD = bytes;
+            HUGE_PAGE_POPULATE = populate;
+        }
+
+        /// Returns the table size from which slots are mapped with huge pages.
+        size_type huge_page_threshold() const noexcept {
+            return HUGE_PAGE_THRESHOLD;
+        }
+
+        /**
+         *  @brief  Returns the bytes held by the %hash_map.
+         *
+         *  Computed from the element, tombstone and slot counters in
+         *  constant time. Allocator bookkeeping and memory owned by the
+         *  elements themselves (e.g. string buffers) are not included.
+         *  The spare group used for cache line alignment, or for huge page
+         *  tables the mapping round-up, counts as slack. A small map
+         *  reports its embedded slot group.
+         */
+        hash_map_memory_usage memory_usage() const noexcept {
+            hash_map_memory_usage usage;
+            usage.table = SIZE * sizeof(slot_type);
+            usage.metadata = table_bytes_helper(SIZE) - usage.table;
+            usage.nodes = NOT_NULL_SIZE * sizeof(hash_node);
+            usage.tombstones = DELETED_SIZE * sizeof(slot_type);
+            usage.slack = (SIZE - NOT_NULL_SIZE) * sizeof(slot_type);
+            usage.backing = BACKING;
+            if(table_memory) {
+                size_type padding = BACKING == table_backing::allocator
+                                    ? sizeof(slot_group)
+                                    : huge_page_region::mapping_size(table_bytes_helper(SIZE)) - table_bytes_helper(SIZE);
+                usage.slack += padding;
+                usage.metadata += padding;
+            }
+            return usage;
+        }
+
+        /// Returns where the current slot table was allocated.
+        table_backing backing() const noexcept {
+            return BACKING;
+        }
+
         /**
          *  @brief  May rehash the %hash_map.
          *  @param  n The new number of buckets.
@@ -1079,30 +2617,48 @@ namespace fefu
          *  %hash_map maximum load factor.
          */
         void rehash(size_type n) {
+            if(n <= NOT_NULL_SIZE)
+                n = NOT_NULL_SIZE + 1;
+            if(small_helper() && n <= slot_group::width)
+                return;
             size_type PAST_SIZE = SIZE;
-            SIZE = n;
-            value_type **temp_table = table_allocator.allocate(SIZE);
-            for(int i = 0; i < SIZE; i++)
-                temp_table[i] = nullptr;
-            NOT_NULL_SIZE = 0;
-            std::swap(temp_table, table);
-            for(int i = 0; i < PAST_SIZE; i++) {
-                if(temp_table[i] != nullptr && !deleted[i]) {
-                    insert({temp_table[i]->first, temp_table[i]->second});
-                }
-            }
-
-            deleted = deleted_allocator.allocate(SIZE);
-            for(int i = 0; i < SIZE; i++)
-                deleted[i] = false;
+            slot_group *past_table = table;
+            slot_group *past_memory = table_memory;
+            table_backing past_backing = BACKING;
+
+            // Nodes are relinked, never copied. Probe sequences cover the whole
+            // table, so the retry with a bigger table only guards policies
+            // that do not.
+            for(;;) {
+                allocate_table_helper(n);
+                NOT_NULL_SIZE = 0;
+                DELETED_SIZE = 0;
+
+                bool relinked = true;
+                for_each_element_helper(past_table, PAST_SIZE, [this, past_table, &relinked](size_type i) {
+                    if(!relinked)
+                        return;
+                    // Keys are unique and the new table has no tombstones, so
+                    // the first free slot is the one a lookup would stop at.
+                    // Cached hashes spare the hash functors and the keys.
+                    const slot_type& slot = past_table[i / slot_group::width].slots[i % slot_group::width];
+                    size_type length = 0;
+                    size_type x = find_free_slot_helper(slot->hash, &length);
+                    if(x == SIZE) {
+                        relinked = false;
+                    } else {
+                        place_slot_helper(x, slot);
+                        note_probe_length_helper(length);
+                    }
+                });
+                if(relinked)
+                    break;
 
-            for(int i = 0; i < PAST_SIZE; i++) {
-                if(temp_table[i])
-                    delete temp_table[i];
+                deallocate_table_helper(table_memory, SIZE, BACKING);
+                n = 2 * n;
             }
 
-            table_allocator.deallocate(temp_table,PAST_SIZE);
-
+            deallocate_table_helper(past_memory, PAST_SIZE, past_backing);
         }
 
         /**
@@ -1117,6 +2673,247 @@ namespace fefu
         }
     };
 
+    /**
+     *  @brief  Erases every element of @a map that satisfies @a pred.
+     *  @param  map   An %hash_map.
+     *  @param  pred  A predicate called with a reference to each element.
+     *  @return  The number of elements erased.
+     *
+     *  The slots are walked once and matching nodes are freed in place.
+     *  If the sweep leaves tombstones as the dominant part of the load,
+     *  they are dropped without reallocating the table.
+     */
+    template<typename K, typename T, class FirstHash, class SecondHash,
+            typename Pred, typename Alloc, typename ProbePolicy, typename Predicate>
+    typename hash_map<K, T, FirstHash, SecondHash, Pred, Alloc, ProbePolicy>::size_type
+    erase_if(hash_map<K, T, FirstHash, SecondHash, Pred, Alloc, ProbePolicy>& map, Predicate pred) {
+        typename hash_map<K, T, FirstHash, SecondHash, Pred, Alloc, ProbePolicy>::size_type erased = 0;
+        map.for_each_element_helper(map.table, map.SIZE, [&map, &pred, &erased](std::size_t i) {
+            if(pred(*map.slot_helper(i)->value())) {
+                map.destroy_node_helper(map.take_node_helper(i));
+                erased++;
+            }
+        });
+        if(map.DELETED_SIZE > map.NOT_NULL_SIZE)
+            map.drop_deleted_helper();
+        return erased;
+    }
+
+    /**
+     *  Members shared by the sibling maps of %hash_map (%soa_hash_map,
+     *  %compact_hash_map and the others), written once over what each of
+     *  them provides: size(), begin(), end(), find(), get_allocator(),
+     *  try_emplace_helper(key, args...) and swap_helper(x, allocators),
+     *  which swaps the contents and the functors of two maps, and their
+     *  allocators too when allocators is set.
+     *
+     *  Map derives from it and befriends it. Its assignment operators call
+     *  copy_assign_helper() and move_assign_helper(), which follow the
+     *  propagate_on_container_* traits of the allocator as %hash_map does,
+     *  and its move constructor with allocator argument calls
+     *  move_construct_helper(). Both rely on Map having the copy and move
+     *  constructors with allocator argument.
+     */
+    template<typename Map, typename K, typename T>
+    class hash_map_container_base {
+    public:
+        using key_type = K;
+        using mapped_type = T;
+        using value_type = std::pair<const key_type, mapped_type>;
+        using size_type = std::size_t;
+
+        ///  Returns true if the map is empty.
+        bool empty() const noexcept {
+            return self().size() == 0;
+        }
+
+        auto cbegin() const noexcept {
+            return self().begin();
+        }
+
+        auto cend() const noexcept {
+            return self().end();
+        }
+
+        //@{
+        /**
+         *  @brief Inserts a (key, value) pair constructed in place if the key
+         *  is absent.
+         *  @return  A pair of an iterator to the element with key @a k and
+         *           whether it was inserted.
+         */
+        template <typename... _Args>
+        auto try_emplace(const key_type& k, _Args&&... args) {
+            return self().try_emplace_helper(k, std::forward<_Args>(args)...);
+        }
+
+        template <typename... _Args>
+        auto try_emplace(key_type&& k, _Args&&... args) {
+            return self().try_emplace_helper(std::move(k), std::forward<_Args>(args)...);
+        }
+        //@}
+
+        //@{
+        /**
+         *  @brief Attempts to insert a (key, value) pair into the map.
+         *  @return  A pair of an iterator to the element with the key of
+         *           @a value and whether it was inserted.
+         */
+        auto insert(const value_type& value) {
+            return self().try_emplace_helper(value.first, value.second);
+        }
+
+        auto insert(value_type&& value) {
+            return self().try_emplace_helper(value.first, std::move(value.second));
+        }
+
+        void insert(std::initializer_list<value_type> l) {
+            for(const value_type& value : l)
+                insert(value);
+        }
+        //@}
+
+        /**
+         *  @brief Builds a (key, value) pair from @a args and inserts it if
+         *  its key is absent.
+         *  @return  A pair of an iterator to the element with that key and
+         *           whether it was inserted.
+         *
+         *  Unlike %hash_map::emplace() the pair is built as a temporary and
+         *  then moved into place, since the maps do not all store pairs.
+         */
+        template <typename... _Args>
+        auto emplace(_Args&&... args) {
+            std::pair<K, T> value(std::forward<_Args>(args)...);
+            return self().try_emplace_helper(std::move(value.first), std::move(value.second));
+        }
+
+        //@{
+        /**
+         *  @brief Inserts (key, obj) if the key is absent, assigns obj to its
+         *  mapped value otherwise.
+         *  @return  A pair of an iterator to the element with key @a k and
+         *           whether it was inserted.
+         */
+        template <typename _Obj>
+        auto insert_or_assign(const key_type& k, _Obj&& obj) {
+            auto result = self().try_emplace_helper(k, std::forward<_Obj>(obj));
+            if(!result.second)
+                result.first->second = std::forward<_Obj>(obj);
+            return result;
+        }
+
+        template <typename _Obj>
+        auto insert_or_assign(key_type&& k, _Obj&& obj) {
+            auto result = self().try_emplace_helper(std::move(k), std::forward<_Obj>(obj));
+            if(!result.second)
+                result.first->second = std::forward<_Obj>(obj);
+            return result;
+        }
+        //@}
+
+        /// Returns the number of elements with key @a key, 0 or 1.
+        size_type count(const key_type& key) const {
+            return contains(key) ? 1 : 0;
+        }
+
+        /// Finds whether an element with the given key exists.
+        bool contains(const key_type& key) const {
+            return self().find(key) != self().end();
+        }
+
+        /**
+         *  @brief  Subscript ( @c [] ) access to map data.
+         *  @param  k  The key for which data should be retrieved.
+         *  @return  A reference to the value of @a k, value-initialised if
+         *           the key was absent.
+         */
+        mapped_type& operator[](const key_type& k) {
+            return self().try_emplace_helper(k).first->second;
+        }
+
+        //@{
+        /**
+         *  @brief  Access to map data.
+         *  @param  k  The key for which data should be retrieved.
+         *  @return  A reference to the value of @a k.
+         *  @throw  std::out_of_range  If no such data is present.
+         */
+        mapped_type& at(const key_type& k) {
+            auto it = self().find(k);
+            if(it == self().end())
+                throw std::out_of_range("key not found");
+            return it->second;
+        }
+
+        const mapped_type& at(const key_type& k) const {
+            auto it = self().find(k);
+            if(it == self().end())
+                throw std::out_of_range("key not found");
+            return it->second;
+        }
+        //@}
+
+        /// Swaps data with another map. Allocators are swapped as
+        /// propagate_on_container_swap says.
+        void swap(Map& x) {
+            using traits = std::allocator_traits<typename Map::allocator_type>;
+            self().swap_helper(x, traits::propagate_on_container_swap::value);
+        }
+
+    protected:
+        // The copy is made with the allocator the assigned map keeps, so its
+        // contents can always be swapped in.
+        Map& copy_assign_helper(const Map& other) {
+            using traits = std::allocator_traits<typename Map::allocator_type>;
+            if(this != &other) {
+                bool propagate = traits::propagate_on_container_copy_assignment::value;
+                Map copy(other, propagate ? other.get_allocator() : self().get_allocator());
+                self().swap_helper(copy, propagate);
+            }
+            return self();
+        }
+
+        // Without propagation the memory of other is only taken over if the
+        // allocators compare equal, see move_construct_helper().
+        Map& move_assign_helper(Map&& other) {
+            using traits = std::allocator_traits<typename Map::allocator_type>;
+            if(this != &other) {
+                if(traits::propagate_on_container_move_assignment::value) {
+                    Map moved(std::move(other));
+                    self().swap_helper(moved, true);
+                } else {
+                    Map moved(std::move(other), self().get_allocator());
+                    self().swap_helper(moved, false);
+                }
+            }
+            return self();
+        }
+
+        // Fills a map just built with the allocator it keeps and a copy of
+        // the functors of other: the contents of other are swapped in if
+        // the allocators compare equal, and moved element by element
+        // otherwise.
+        void move_construct_helper(Map& other) {
+            if(self().get_allocator() == other.get_allocator()) {
+                self().swap_helper(other, false);
+                return;
+            }
+            for(auto it = other.begin(); it != other.end(); ++it)
+                self().try_emplace_helper(it->first, std::move(it->second));
+            other.clear();
+        }
+
+    private:
+        Map& self() noexcept {
+            return static_cast<Map&>(*this);
+        }
+
+        const Map& self() const noexcept {
+            return static_cast<const Map&>(*this);
+        }
+    };
+
 } // namespace fefu
 
 
@@ -0,0 +1,669 @@
+#ifndef HASHMAP_INTEGER_HASH_MAP_H
+#define HASHMAP_INTEGER_HASH_MAP_H
+
+
+#pragma once
+
+#include "hash_map.h"
+
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+namespace fefu
+{
+
+    /**
+     *  Iterator of an %integer_hash_map. Slots [0, size) of the table are
+     *  occupied when their key is neither sentinel; slots size and size + 1
+     *  are the side slots of the two sentinel keys.
+     */
+    template<typename K, typename T>
+    class integer_hash_map_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<const K, typename std::remove_const<T>::type>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::pair<const K&, T&>;
+
+        // Keeps the pair of references alive for operator->.
+        struct pointer {
+            reference ref;
+            reference* operator->() noexcept {
+                return &ref;
+            }
+        };
+
+        integer_hash_map_iterator() noexcept {}
+
+        integer_hash_map_iterator(const K* keys, T* values, const bool* side_full,
+                                  K empty_key, K deleted_key, size_t cur_index, size_t size) noexcept
+        : keys(keys), values(values), side_full(side_full), empty_key(empty_key),
+          deleted_key(deleted_key), cur_index(cur_index), size(size) {}
+
+        template<typename U, typename = typename std::enable_if<std::is_same<const U, T>::value>::type>
+        integer_hash_map_iterator(const integer_hash_map_iterator<K, U>& other) noexcept
+        : keys(other.keys), values(other.values), side_full(other.side_full), empty_key(other.empty_key),
+          deleted_key(other.deleted_key), cur_index(other.cur_index), size(other.size) {}
+
+        reference operator*() const {
+            return {keys[cur_index], values[cur_index]};
+        }
+        pointer operator->() const {
+            return {**this};
+        }
+
+        // prefix ++
+        integer_hash_map_iterator& operator++() {
+            cur_index++;
+            seek_helper();
+            return *this;
+        }
+        // postfix ++
+        integer_hash_map_iterator operator++(int) {
+            integer_hash_map_iterator old = *this;
+            ++(*this);
+            return old;
+        }
+
+        friend bool operator==(const integer_hash_map_iterator& l_point, const integer_hash_map_iterator& r_point) {
+            return l_point.keys == r_point.keys && l_point.cur_index == r_point.cur_index;
+        }
+        friend bool operator!=(const integer_hash_map_iterator& l_point, const integer_hash_map_iterator& r_point) {
+            return !(l_point == r_point);
+        }
+
+    private:
+        template<typename, typename>
+        friend class integer_hash_map_iterator;
+        template<typename, typename, class, class, typename>
+        friend class integer_hash_map;
+
+        void seek_helper() noexcept {
+            for (; cur_index < size; cur_index++) {
+                if (keys[cur_index] != empty_key && keys[cur_index] != deleted_key)
+                    return;
+            }
+            for (; cur_index < size + 2; cur_index++) {
+                if (side_full[cur_index - size])
+                    return;
+            }
+        }
+
+        const K* keys;
+        T* values;
+        const bool* side_full;
+        K empty_key;
+        K deleted_key;
+        size_t cur_index;
+        size_t size;
+    };
+
+
+    /**
+     *  Open addressing map for integral keys. Keys are stored inline in a
+     *  key array and mark the state of their slot themselves: two reserved
+     *  key values stand for empty and deleted slots, so the table needs
+     *  neither node pointers nor a state array. Mapped values live in a
+     *  parallel array, as in %soa_hash_map.
+     *
+     *  The sentinels are chosen at construction and default to the two
+     *  largest values of K. Elements whose key equals a sentinel are still
+     *  allowed: they are kept in two side slots past the end of the table.
+     *
+     *  Elements move on rehash, which invalidates references into the map.
+     *  Iterators are also invalidated by swap and move.
+     */
+    template<typename K, typename T,
+            class FirstHash = FirstKeyHash<K>,
+            class SecondHash = SecondKeyHash<K>,
+            typename Alloc = allocator<std::pair<const K, T>*>>
+    class integer_hash_map : public hash_map_container_base<integer_hash_map<K, T, FirstHash, SecondHash, Alloc>, K, T>
+    {
+        static_assert(std::is_integral<K>::value, "integer_hash_map needs an integral key type");
+
+    public:
+        using key_type = K;
+        using mapped_type = T;
+        using allocator_type = Alloc;
+        using value_type = std::pair<const key_type, mapped_type>;
+        using iterator = integer_hash_map_iterator<key_type, mapped_type>;
+        using const_iterator = integer_hash_map_iterator<key_type, const mapped_type>;
+        using size_type = std::size_t;
+
+    private:
+        // Alloc is rebound for the key and the value arrays.
+        using alloc_traits = std::allocator_traits<allocator_type>;
+        using key_allocator_type = typename alloc_traits::template rebind_alloc<key_type>;
+        using value_allocator_type = typename alloc_traits::template rebind_alloc<mapped_type>;
+        using key_alloc_traits = std::allocator_traits<key_allocator_type>;
+        using value_alloc_traits = std::allocator_traits<value_allocator_type>;
+        using index_allocator_type = typename alloc_traits::template rebind_alloc<size_type>;
+        using index_alloc_traits = std::allocator_traits<index_allocator_type>;
+
+        // Size of the first table, allocated by the first insert.
+        static constexpr size_type INITIAL_SIZE = 37;
+
+        // The table has SIZE slots followed by the two side slots. Only
+        // elements of the table proper count in NOT_NULL_SIZE.
+        size_type SIZE = 0;
+        size_type NOT_NULL_SIZE = 0;
+        size_type DELETED_SIZE = 0;
+        float LOAD_FACTOR = 0.7;
+        key_type EMPTY_KEY = std::numeric_limits<key_type>::max();
+        key_type DELETED_KEY = std::numeric_limits<key_type>::max() - 1;
+        bool side_full[2] = {false, false};
+        key_type* keys = nullptr;
+        mapped_type* values = nullptr;
+        FirstHash firstHash;
+        SecondHash secondHash;
+        key_allocator_type key_allocator{allocator_type()};
+        value_allocator_type value_allocator{key_allocator};
+
+        bool occupied_helper(size_type x) const noexcept {
+            return x < SIZE ? keys[x] != EMPTY_KEY && keys[x] != DELETED_KEY : side_full[x - SIZE];
+        }
+
+        // Allocates an empty table of n slots plus the side slots. Values are
+        // constructed as slots fill.
+        void allocate_arrays_helper(size_type n) {
+            size_type size = n < 2 ? 2 : n;
+            key_type* new_keys = key_alloc_traits::allocate(key_allocator, size + 2);
+            try {
+                values = value_alloc_traits::allocate(value_allocator, size + 2);
+            } catch(...) {
+                key_alloc_traits::deallocate(key_allocator, new_keys, size + 2);
+                throw;
+            }
+            keys = new_keys;
+            SIZE = size;
+            for(size_type x = 0; x < SIZE; x++)
+                keys[x] = EMPTY_KEY;
+            keys[SIZE] = EMPTY_KEY;
+            keys[SIZE + 1] = DELETED_KEY;
+        }
+
+        void deallocate_arrays_helper(key_type* old_keys, mapped_type* old_values, size_type n) {
+            if(old_keys == nullptr)
+                return;
+            value_alloc_traits::deallocate(value_allocator, old_values, n + 2);
+            key_alloc_traits::deallocate(key_allocator, old_keys, n + 2);
+        }
+
+        void destroy_elements_helper() {
+            for(size_type x = 0; x < SIZE + 2; x++) {
+                if(occupied_helper(x))
+                    value_alloc_traits::destroy(value_allocator, values + x);
+            }
+            side_full[0] = false;
+            side_full[1] = false;
+        }
+
+        void release_helper() noexcept {
+            deallocate_arrays_helper(keys, values, SIZE);
+            keys = nullptr;
+            values = nullptr;
+            SIZE = 0;
+            NOT_NULL_SIZE = 0;
+            DELETED_SIZE = 0;
+        }
+
+        // Clones other slot by slot. Keys are plain integers and are copied
+        // with the whole key array.
+        void copy_elements_helper(const integer_hash_map& other) {
+            if(other.SIZE == 0)
+                return;
+            allocate_arrays_helper(other.SIZE);
+            size_type x = 0;
+            try {
+                for(; x < SIZE + 2; x++) {
+                    if(other.occupied_helper(x))
+                        value_alloc_traits::construct(value_allocator, values + x, other.values[x]);
+                }
+            } catch(...) {
+                for(size_type y = 0; y < x; y++) {
+                    if(other.occupied_helper(y))
+                        value_alloc_traits::destroy(value_allocator, values + y);
+                }
+                release_helper();
+                throw;
+            }
+            std::copy(other.keys, other.keys + SIZE, keys);
+            side_full[0] = other.side_full[0];
+            side_full[1] = other.side_full[1];
+            NOT_NULL_SIZE = other.NOT_NULL_SIZE;
+            DELETED_SIZE = other.DELETED_SIZE;
+        }
+
+        void steal_elements_helper(integer_hash_map& other) noexcept {
+            SIZE = other.SIZE;
+            NOT_NULL_SIZE = other.NOT_NULL_SIZE;
+            DELETED_SIZE = other.DELETED_SIZE;
+            keys = other.keys;
+            values = other.values;
+            side_full[0] = other.side_full[0];
+            side_full[1] = other.side_full[1];
+            other.SIZE = 0;
+            other.NOT_NULL_SIZE = 0;
+            other.DELETED_SIZE = 0;
+            other.keys = nullptr;
+            other.values = nullptr;
+            other.side_full[0] = false;
+            other.side_full[1] = false;
+        }
+
+        iterator make_iterator(size_type x) {
+            return iterator(keys, values, side_full, EMPTY_KEY, DELETED_KEY, x, SIZE);
+        }
+
+        const_iterator make_iterator(size_type x) const {
+            return const_iterator(keys, values, side_full, EMPTY_KEY, DELETED_KEY, x, SIZE);
+        }
+
+        // Grows or compacts the table if it would exceed the load factor
+        // after taking incoming more elements. Returns whether it did.
+        bool check_load_factor(size_type incoming) {
+            if(SIZE == 0)
+                return false;
+            if((float)(NOT_NULL_SIZE + DELETED_SIZE + incoming) / (float)SIZE >= LOAD_FACTOR) {
+                if((float)NOT_NULL_SIZE / (float)SIZE < LOAD_FACTOR / 2)
+                    rehash(SIZE);
+                else
+                    rehash(2 * SIZE + 1);
+                return true;
+            }
+            return false;
+        }
+
+        bool sentinel_helper(const key_type& key) const noexcept {
+            return key == EMPTY_KEY || key == DELETED_KEY;
+        }
+
+        // Returns the slot of key and true, or the slot an insert of key
+        // should use and false. SIZE stands for no free slot. Sentinel keys
+        // are answered from their side slot.
+        std::pair<size_type, bool> find_position_helper(const key_type& key) const {
+            if (SIZE == 0)
+                return {SIZE, false};
+            if (sentinel_helper(key)) {
+                size_type x = key == EMPTY_KEY ? SIZE : SIZE + 1;
+                return {x, side_full[x - SIZE]};
+            }
+            hash_map_key_hash h = hash_key(firstHash, secondHash, key);
+            double_hash_probe::sequence probe(h, SIZE);
+            size_type free_slot = SIZE;
+            for (size_type i = 0; i < SIZE; i++, probe.next()) {
+                size_type x = probe.group();
+                key_type slot_key = keys[x];
+                if (slot_key == key) {
+                    return {x, true};
+                } else if (slot_key == DELETED_KEY) {
+                    if (free_slot == SIZE)
+                        free_slot = x;
+                } else if (slot_key == EMPTY_KEY) {
+                    return {free_slot == SIZE ? x : free_slot, false};
+                }
+            }
+            return {free_slot, false};
+        }
+
+        // Probes the keys of the current table only.
+        size_type find_free_slot_helper(const key_type& key) const {
+            hash_map_key_hash h = hash_key(firstHash, secondHash, key);
+            double_hash_probe::sequence probe(h, SIZE);
+            for (size_type i = 0; i < SIZE; i++, probe.next()) {
+                size_type x = probe.group();
+                if (sentinel_helper(keys[x]))
+                    return x;
+            }
+            return SIZE;
+        }
+
+        std::pair<size_type, bool> find_insert_position_helper(const key_type& key) {
+            if (SIZE == 0)
+                rehash(INITIAL_SIZE);
+            if (sentinel_helper(key))
+                return find_position_helper(key);
+            auto pos = find_position_helper(key);
+            while (!pos.second && pos.first == SIZE) {
+                rehash(2 * SIZE + 1);
+                pos = find_position_helper(key);
+            }
+            return pos;
+        }
+
+        template<typename... _Args>
+        std::pair<iterator, bool> try_emplace_helper(const key_type& k, _Args&&... args) {
+            auto pos = find_insert_position_helper(k);
+            if (pos.second)
+                return {make_iterator(pos.first), false};
+            size_type x = pos.first;
+            if (x >= SIZE) {
+                value_alloc_traits::construct(value_allocator, values + x, std::forward<_Args>(args)...);
+                side_full[x - SIZE] = true;
+                return {make_iterator(x), true};
+            }
+            // Elements move on rehash, so the table makes room before the
+            // new element is constructed.
+            if (check_load_factor(1))
+                x = find_insert_position_helper(k).first;
+            value_alloc_traits::construct(value_allocator, values + x, std::forward<_Args>(args)...);
+            if (keys[x] == DELETED_KEY)
+                DELETED_SIZE--;
+            keys[x] = k;
+            NOT_NULL_SIZE++;
+            return {make_iterator(x), true};
+        }
+
+        void erase_slot_helper(size_type x) {
+            value_alloc_traits::destroy(value_allocator, values + x);
+            if (x >= SIZE) {
+                side_full[x - SIZE] = false;
+                return;
+            }
+            keys[x] = DELETED_KEY;
+            NOT_NULL_SIZE--;
+            DELETED_SIZE++;
+        }
+
+        friend class hash_map_container_base<integer_hash_map, K, T>;
+
+        void swap_helper(integer_hash_map& x, bool allocators) {
+            std::swap(SIZE, x.SIZE);
+            std::swap(NOT_NULL_SIZE, x.NOT_NULL_SIZE);
+            std::swap(DELETED_SIZE, x.DELETED_SIZE);
+            std::swap(LOAD_FACTOR, x.LOAD_FACTOR);
+            std::swap(EMPTY_KEY, x.EMPTY_KEY);
+            std::swap(DELETED_KEY, x.DELETED_KEY);
+            std::swap(side_full[0], x.side_full[0]);
+            std::swap(side_full[1], x.side_full[1]);
+            std::swap(keys, x.keys);
+            std::swap(values, x.values);
+            std::swap(firstHash, x.firstHash);
+            std::swap(secondHash, x.secondHash);
+            if(allocators) {
+                std::swap(key_allocator, x.key_allocator);
+                std::swap(value_allocator, x.value_allocator);
+            }
+        }
+
+    public:
+        /// Default constructor. The first insert allocates the table.
+        integer_hash_map() {}
+
+        /**
+         *  @brief  Creates a map that uses the given sentinel keys.
+         *  @param  empty_key  Key value marking empty slots.
+         *  @param  deleted_key  Key value marking erased slots.
+         *  @throw  std::invalid_argument  If both sentinels are equal.
+         */
+        integer_hash_map(key_type empty_key, key_type deleted_key)
+        : EMPTY_KEY(empty_key), DELETED_KEY(deleted_key) {
+            if(empty_key == deleted_key)
+                throw std::invalid_argument("sentinel keys must differ");
+        }
+
+        explicit integer_hash_map(const allocator_type& a)
+        : key_allocator(a), value_allocator(a) {}
+
+        /// Copy constructor.
+        integer_hash_map(const integer_hash_map& other)
+        : integer_hash_map(other, alloc_traits::select_on_container_copy_construction(other.get_allocator())) {}
+
+        /// Copy constructor with allocator argument.
+        integer_hash_map(const integer_hash_map& other, const allocator_type& a)
+        : LOAD_FACTOR(other.LOAD_FACTOR), EMPTY_KEY(other.EMPTY_KEY), DELETED_KEY(other.DELETED_KEY),
+          firstHash(other.firstHash), secondHash(other.secondHash), key_allocator(a), value_allocator(a) {
+            copy_elements_helper(other);
+        }
+
+        /// Move constructor.
+        integer_hash_map(integer_hash_map&& other)
+        : LOAD_FACTOR(other.LOAD_FACTOR), EMPTY_KEY(other.EMPTY_KEY), DELETED_KEY(other.DELETED_KEY),
+          firstHash(std::move(other.firstHash)), secondHash(std::move(other.secondHash)),
+          key_allocator(std::move(other.key_allocator)), value_allocator(std::move(other.value_allocator)) {
+            steal_elements_helper(other);
+        }
+
+        /**
+         *  @brief  Move constructor with allocator argument.
+         *
+         *  The memory of @a other is adopted only if its allocator compares
+         *  equal to @a a; otherwise its elements are moved one by one.
+         */
+        integer_hash_map(integer_hash_map&& other, const allocator_type& a)
+        : LOAD_FACTOR(other.LOAD_FACTOR), EMPTY_KEY(other.EMPTY_KEY), DELETED_KEY(other.DELETED_KEY),
+          firstHash(other.firstHash), secondHash(other.secondHash), key_allocator(a), value_allocator(a) {
+            this->move_construct_helper(other);
+        }
+
+        /// Builds an %integer_hash_map from an initializer_list.
+        integer_hash_map(std::initializer_list<value_type> l) {
+            this->insert(l);
+        }
+
+        ~integer_hash_map() {
+            if(keys == nullptr)
+                return;
+            destroy_elements_helper();
+            deallocate_arrays_helper(keys, values, SIZE);
+        }
+
+        /// Copy assignment operator.
+        integer_hash_map& operator=(const integer_hash_map& other) {
+            return this->copy_assign_helper(other);
+        }
+
+        /// Move assignment operator.
+        integer_hash_map& operator=(integer_hash_map&& other) {
+            return this->move_assign_helper(std::move(other));
+        }
+
+        ///  Returns the allocator object used by the %integer_hash_map.
+        allocator_type get_allocator() const noexcept {
+            return allocator_type(key_allocator);
+        }
+
+        ///  Returns the size of the %integer_hash_map.
+        size_type size() const noexcept {
+            return NOT_NULL_SIZE + side_full[0] + side_full[1];
+        }
+
+        ///  Returns the number of slots of the %integer_hash_map.
+        size_type max_size() const noexcept {
+            return SIZE;
+        }
+
+        /// Returns the key value that marks empty slots.
+        key_type empty_key() const noexcept {
+            return EMPTY_KEY;
+        }
+
+        /// Returns the key value that marks erased slots.
+        key_type deleted_key() const noexcept {
+            return DELETED_KEY;
+        }
+
+        iterator begin() noexcept {
+            iterator it = make_iterator(0);
+            if(SIZE != 0)
+                it.seek_helper();
+            return it;
+        }
+
+        const_iterator begin() const noexcept {
+            const_iterator it = make_iterator(0);
+            if(SIZE != 0)
+                it.seek_helper();
+            return it;
+        }
+
+        iterator end() noexcept {
+            return make_iterator(SIZE == 0 ? 0 : SIZE + 2);
+        }
+
+        const_iterator end() const noexcept {
+            return make_iterator(SIZE == 0 ? 0 : SIZE + 2);
+        }
+
+        /**
+         *  @brief Erases elements according to the provided key.
+         *  @param  key  Key of element to be erased.
+         *  @return  The number of elements erased.
+         */
+        size_type erase(const key_type& key) {
+            auto pos = find_position_helper(key);
+            if (!pos.second)
+                return 0;
+            erase_slot_helper(pos.first);
+            return 1;
+        }
+
+        /**
+         *  @brief Erases an element from an %integer_hash_map.
+         *  @param  position  An iterator pointing to the element to be erased.
+         *  @return An iterator pointing to the next element.
+         */
+        iterator erase(const_iterator position) {
+            size_type x = position.cur_index;
+            erase_slot_helper(x);
+            iterator next = make_iterator(x);
+            ++next;
+            return next;
+        }
+
+        /// Erases all elements and releases the table.
+        void clear() noexcept {
+            if(keys == nullptr)
+                return;
+            destroy_elements_helper();
+            release_helper();
+        }
+
+        //@{
+        /**
+         *  @brief Tries to locate an element in an %integer_hash_map.
+         *  @param  key  Key to be located.
+         *  @return  Iterator pointing to sought-after element, or end() if not
+         *           found.
+         */
+        iterator find(const key_type& key) {
+            auto pos = find_position_helper(key);
+            return pos.second ? make_iterator(pos.first) : end();
+        }
+
+        const_iterator find(const key_type& key) const {
+            auto pos = find_position_helper(key);
+            return pos.second ? make_iterator(pos.first) : end();
+        }
+        //@}
+
+        /// Returns the average number of elements per slot.
+        float load_factor() const noexcept {
+            return SIZE == 0 ? 0 : (float)NOT_NULL_SIZE / (float)SIZE;
+        }
+
+        /// Returns the load factor the %integer_hash_map keeps below.
+        float max_load_factor() const noexcept {
+            return LOAD_FACTOR;
+        }
+
+        /// Changes the maximum load factor. z must lie in (0, 1).
+        void max_load_factor(float z) {
+            LOAD_FACTOR = z;
+            check_load_factor(0);
+        }
+
+        /**
+         *  @brief  Rebuilds the table with at least @a n slots.
+         *
+         *  Keys are placed in the new key array first, so a probe sequence
+         *  running out of free slots retries with a bigger table before any
+         *  value has moved.
+         */
+        void rehash(size_type n) {
+            if(n <= NOT_NULL_SIZE)
+                n = NOT_NULL_SIZE + 1;
+            size_type PAST_SIZE = SIZE;
+            key_type* past_keys = keys;
+            mapped_type* past_values = values;
+            // Slot of each old element in the new table, found before any
+            // value moves.
+            index_allocator_type index_allocator(key_allocator);
+            size_type* target = index_alloc_traits::allocate(index_allocator, PAST_SIZE);
+
+            for(;;) {
+                try {
+                    allocate_arrays_helper(n);
+                } catch(...) {
+                    index_alloc_traits::deallocate(index_allocator, target, PAST_SIZE);
+                    SIZE = PAST_SIZE;
+                    keys = past_keys;
+                    values = past_values;
+                    throw;
+                }
+                bool placed = true;
+                for(size_type i = 0; placed && i < PAST_SIZE; i++) {
+                    if(sentinel_helper(past_keys[i]))
+                        continue;
+                    size_type x = find_free_slot_helper(past_keys[i]);
+                    if(x == SIZE) {
+                        placed = false;
+                    } else {
+                        keys[x] = past_keys[i];
+                        target[i] = x;
+                    }
+                }
+                if(placed)
+                    break;
+                deallocate_arrays_helper(keys, values, SIZE);
+                n = 2 * n + 1;
+            }
+
+            // Old slot i, side slots included, holds a value that goes to
+            // new slot x.
+            auto full = [&](size_type i) {
+                return i < PAST_SIZE ? !sentinel_helper(past_keys[i]) : side_full[i - PAST_SIZE];
+            };
+            auto destination = [&](size_type i) {
+                return i < PAST_SIZE ? target[i] : SIZE + (i - PAST_SIZE);
+            };
+            size_type i = 0;
+            try {
+                for(; i < PAST_SIZE + 2; i++) {
+                    if(full(i))
+                        value_alloc_traits::construct(value_allocator, values + destination(i),
+                                                      std::move_if_noexcept(past_values[i]));
+                }
+            } catch(...) {
+                for(size_type j = 0; j < i; j++) {
+                    if(full(j))
+                        value_alloc_traits::destroy(value_allocator, values + destination(j));
+                }
+                deallocate_arrays_helper(keys, values, SIZE);
+                index_alloc_traits::deallocate(index_allocator, target, PAST_SIZE);
+                SIZE = PAST_SIZE;
+                keys = past_keys;
+                values = past_values;
+                throw;
+            }
+            for(i = 0; i < PAST_SIZE + 2; i++) {
+                if(full(i))
+                    value_alloc_traits::destroy(value_allocator, past_values + i);
+            }
+            index_alloc_traits::deallocate(index_allocator, target, PAST_SIZE);
+            DELETED_SIZE = 0;
+            deallocate_arrays_helper(past_keys, past_values, PAST_SIZE);
+        }
+
+        /// Prepares the %integer_hash_map for @a n elements.
+        void reserve(size_type n) {
+            rehash(ceil((float)n / (float)max_load_factor()));
+        }
+    };
+
+} // namespace fefu
+
+
+
+#endif //HASHMAP_INTEGER_HASH_MAP_H
@@ -0,0 +1,613 @@
+#ifndef HASHMAP_LINEAR_HASH_MAP_H
+#define HASHMAP_LINEAR_HASH_MAP_H
+
+
+#pragma once
+
+#include "hash_map.h"
+
+#include <iterator>
+#include <stdexcept>
+
+namespace fefu
+{
+
+    /**
+     *  Chain node of a %linear_hash_map. The cached hashes let a split
+     *  decide where each node goes without hashing its key again.
+     */
+    template<typename Value>
+    struct linear_hash_map_node {
+        linear_hash_map_node* next;
+        hash_map_key_hash hash;
+        typename std::aligned_storage<sizeof(Value), alignof(Value)>::type storage;
+
+        Value* value() noexcept {
+            return reinterpret_cast<Value*>(&storage);
+        }
+
+        const Value* value() const noexcept {
+            return reinterpret_cast<const Value*>(&storage);
+        }
+    };
+
+
+    /**
+     *  Iterator of a %linear_hash_map. Walks the buckets in index order and
+     *  each chain front to back, handing out element pointers like the
+     *  %hash_map iterators.
+     */
+    template<typename ValueType, std::size_t SegmentSize>
+    class linear_hash_map_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ValueType;
+        using difference_type = std::ptrdiff_t;
+        using reference = ValueType*;
+        using pointer = ValueType*;
+        using node_type = linear_hash_map_node<typename std::remove_const<ValueType>::type>;
+
+        linear_hash_map_iterator() noexcept {}
+
+        linear_hash_map_iterator(node_type** const* segments, size_t bucket, node_type* node, size_t buckets) noexcept
+        : segments(segments), bucket(bucket), node(node), buckets(buckets) {}
+
+        template<typename U, typename = typename std::enable_if<std::is_same<const U, ValueType>::value>::type>
+        linear_hash_map_iterator(const linear_hash_map_iterator<U, SegmentSize>& other) noexcept
+        : segments(other.segments), bucket(other.bucket), node(other.node), buckets(other.buckets) {}
+
+        reference operator*() const {
+            return node->value();
+        }
+        pointer operator->() const {
+            return **this;
+        }
+
+        // prefix ++
+        linear_hash_map_iterator& operator++() {
+            node = node->next;
+            if (node == nullptr) {
+                bucket++;
+                seek_helper();
+            }
+            return *this;
+        }
+        // postfix ++
+        linear_hash_map_iterator operator++(int) {
+            linear_hash_map_iterator old = *this;
+            ++(*this);
+            return old;
+        }
+
+        friend bool operator==(const linear_hash_map_iterator& l_point, const linear_hash_map_iterator& r_point) {
+            return l_point.node == r_point.node;
+        }
+        friend bool operator!=(const linear_hash_map_iterator& l_point, const linear_hash_map_iterator& r_point) {
+            return !(l_point == r_point);
+        }
+
+    private:
+        template<typename, std::size_t>
+        friend class linear_hash_map_iterator;
+        template<typename, typename, class, class, typename, typename>
+        friend class linear_hash_map;
+
+        // Moves to the head of the next non-empty bucket. The end has no
+        // node.
+        void seek_helper() noexcept {
+            for (; bucket < buckets; bucket++) {
+                node = segments[bucket / SegmentSize][bucket % SegmentSize];
+                if (node != nullptr)
+                    return;
+            }
+            node = nullptr;
+        }
+
+        node_type** const* segments;
+        size_t bucket;
+        node_type* node;
+        size_t buckets;
+    };
+
+
+    /**
+     *  Chained map with linear hashing. The table grows by one bucket at a
+     *  time: whenever the average chain length would pass the load factor,
+     *  the bucket at the split pointer is split into itself and one new
+     *  bucket at the end, and the pointer advances round-robin through the
+     *  current level. The low bits of the first hash address a bucket, with
+     *  one more bit for buckets the current level has already split.
+     *
+     *  Capacity follows the size closely and no insert ever rebuilds the
+     *  table. Buckets are kept in fixed segments of 256 heads, so adding
+     *  one never copies existing buckets either. Elements live in nodes,
+     *  so their addresses stay stable. Erasing does not merge buckets.
+     */
+    template<typename K, typename T,
+            class FirstHash = FirstKeyHash<K>,
+            class SecondHash = SecondKeyHash<K>,
+            typename Pred = std::equal_to<K>,
+            typename Alloc = allocator<std::pair<const K, T>*>>
+    class linear_hash_map : public hash_map_container_base<linear_hash_map<K, T, FirstHash, SecondHash, Pred, Alloc>, K, T>
+    {
+    public:
+        using key_type = K;
+        using mapped_type = T;
+        using allocator_type = Alloc;
+        using value_type = std::pair<const key_type, mapped_type>;
+        using size_type = std::size_t;
+
+    private:
+        // Bucket heads per segment, and buckets at level 0. Both are powers
+        // of two and the level 0 buckets fit the first segment.
+        static constexpr size_type SEGMENT_SIZE = 256;
+        static constexpr size_type INITIAL_BUCKETS = 16;
+
+        // The first hash is 32 bits wide; past that, splits would find no
+        // new address bit.
+        static constexpr std::uint64_t MAX_BUCKETS = std::uint64_t(1) << 32;
+
+        friend class hash_map_container_base<linear_hash_map, K, T>;
+
+        void swap_helper(linear_hash_map& x, bool allocators) {
+            std::swap(BUCKET_COUNT, x.BUCKET_COUNT);
+            std::swap(LEVEL, x.LEVEL);
+            std::swap(SPLIT, x.SPLIT);
+            std::swap(NOT_NULL_SIZE, x.NOT_NULL_SIZE);
+            std::swap(LOAD_FACTOR, x.LOAD_FACTOR);
+            std::swap(segments, x.segments);
+            std::swap(SEGMENT_COUNT, x.SEGMENT_COUNT);
+            std::swap(DIRECTORY_CAPACITY, x.DIRECTORY_CAPACITY);
+            std::swap(firstHash, x.firstHash);
+            std::swap(secondHash, x.secondHash);
+            std::swap(key_equal, x.key_equal);
+            if(allocators) {
+                std::swap(node_allocator, x.node_allocator);
+                std::swap(segment_allocator, x.segment_allocator);
+                std::swap(directory_allocator, x.directory_allocator);
+            }
+        }
+
+    public:
+        using iterator = linear_hash_map_iterator<value_type, SEGMENT_SIZE>;
+        using const_iterator = linear_hash_map_iterator<const value_type, SEGMENT_SIZE>;
+
+    private:
+        using node_type = typename iterator::node_type;
+        using alloc_traits = std::allocator_traits<allocator_type>;
+        using node_allocator_type = typename alloc_traits::template rebind_alloc<node_type>;
+        using segment_allocator_type = typename alloc_traits::template rebind_alloc<node_type*>;
+        using directory_allocator_type = typename alloc_traits::template rebind_alloc<node_type**>;
+        using node_alloc_traits = std::allocator_traits<node_allocator_type>;
+        using segment_alloc_traits = std::allocator_traits<segment_allocator_type>;
+        using directory_alloc_traits = std::allocator_traits<directory_allocator_type>;
+
+        // BUCKET_COUNT is INITIAL_BUCKETS << LEVEL plus the SPLIT buckets of
+        // the current level already split.
+        size_type BUCKET_COUNT = 0;
+        size_type LEVEL = 0;
+        size_type SPLIT = 0;
+        size_type NOT_NULL_SIZE = 0;
+        float LOAD_FACTOR = 1.0;
+        node_type*** segments = nullptr;
+        size_type SEGMENT_COUNT = 0;
+        size_type DIRECTORY_CAPACITY = 0;
+        FirstHash firstHash;
+        SecondHash secondHash;
+        Pred key_equal;
+        node_allocator_type node_allocator{allocator_type()};
+        segment_allocator_type segment_allocator{node_allocator};
+        directory_allocator_type directory_allocator{node_allocator};
+
+        node_type*& bucket_helper(size_type b) const noexcept {
+            return segments[b / SEGMENT_SIZE][b % SEGMENT_SIZE];
+        }
+
+        // Makes sure bucket b has a segment. The directory doubles when it
+        // is full, which copies segment pointers only.
+        void ensure_segment_helper(size_type b) {
+            if (b / SEGMENT_SIZE < SEGMENT_COUNT)
+                return;
+            if (SEGMENT_COUNT == DIRECTORY_CAPACITY) {
+                size_type capacity = DIRECTORY_CAPACITY == 0 ? 1 : 2 * DIRECTORY_CAPACITY;
+                node_type*** directory = directory_alloc_traits::allocate(directory_allocator, capacity);
+                for (size_type s = 0; s < SEGMENT_COUNT; s++)
+                    directory[s] = segments[s];
+                if (segments != nullptr)
+                    directory_alloc_traits::deallocate(directory_allocator, segments, DIRECTORY_CAPACITY);
+                segments = directory;
+                DIRECTORY_CAPACITY = capacity;
+            }
+            node_type** segment = segment_alloc_traits::allocate(segment_allocator, SEGMENT_SIZE);
+            for (size_type x = 0; x < SEGMENT_SIZE; x++)
+                segment[x] = nullptr;
+            segments[SEGMENT_COUNT++] = segment;
+        }
+
+        template<typename... _Args>
+        node_type* create_node_helper(const hash_map_key_hash& h, _Args&&... args) {
+            node_type* node = node_alloc_traits::allocate(node_allocator, 1);
+            try {
+                node_alloc_traits::construct(node_allocator, node->value(), std::forward<_Args>(args)...);
+            } catch(...) {
+                node_alloc_traits::deallocate(node_allocator, node, 1);
+                throw;
+            }
+            node->hash = h;
+            node->next = nullptr;
+            return node;
+        }
+
+        void destroy_node_helper(node_type* node) noexcept {
+            node_alloc_traits::destroy(node_allocator, node->value());
+            node_alloc_traits::deallocate(node_allocator, node, 1);
+        }
+
+        void release_helper() noexcept {
+            for (size_type b = 0; b < BUCKET_COUNT; b++) {
+                node_type* node = bucket_helper(b);
+                while (node != nullptr) {
+                    node_type* next = node->next;
+                    destroy_node_helper(node);
+                    node = next;
+                }
+            }
+            for (size_type s = 0; s < SEGMENT_COUNT; s++)
+                segment_alloc_traits::deallocate(segment_allocator, segments[s], SEGMENT_SIZE);
+            if (segments != nullptr)
+                directory_alloc_traits::deallocate(directory_allocator, segments, DIRECTORY_CAPACITY);
+            segments = nullptr;
+            SEGMENT_COUNT = 0;
+            DIRECTORY_CAPACITY = 0;
+            BUCKET_COUNT = 0;
+            LEVEL = 0;
+            SPLIT = 0;
+            NOT_NULL_SIZE = 0;
+        }
+
+        // Clones other bucket by bucket, keeping the order of every chain.
+        void copy_elements_helper(const linear_hash_map& other) {
+            if (other.BUCKET_COUNT == 0)
+                return;
+            try {
+                while (SEGMENT_COUNT < other.SEGMENT_COUNT)
+                    ensure_segment_helper(SEGMENT_COUNT * SEGMENT_SIZE);
+                BUCKET_COUNT = other.BUCKET_COUNT;
+                for (size_type b = 0; b < BUCKET_COUNT; b++) {
+                    node_type** tail = &bucket_helper(b);
+                    for (const node_type* node = other.bucket_helper(b); node != nullptr; node = node->next) {
+                        *tail = create_node_helper(node->hash, *node->value());
+                        tail = &(*tail)->next;
+                        NOT_NULL_SIZE++;
+                    }
+                }
+            } catch(...) {
+                release_helper();
+                throw;
+            }
+            LEVEL = other.LEVEL;
+            SPLIT = other.SPLIT;
+        }
+
+        void steal_elements_helper(linear_hash_map& other) noexcept {
+            BUCKET_COUNT = other.BUCKET_COUNT;
+            LEVEL = other.LEVEL;
+            SPLIT = other.SPLIT;
+            NOT_NULL_SIZE = other.NOT_NULL_SIZE;
+            segments = other.segments;
+            SEGMENT_COUNT = other.SEGMENT_COUNT;
+            DIRECTORY_CAPACITY = other.DIRECTORY_CAPACITY;
+            other.BUCKET_COUNT = 0;
+            other.LEVEL = 0;
+            other.SPLIT = 0;
+            other.NOT_NULL_SIZE = 0;
+            other.segments = nullptr;
+            other.SEGMENT_COUNT = 0;
+            other.DIRECTORY_CAPACITY = 0;
+        }
+
+        iterator make_iterator(size_type b, node_type* node) const {
+            return iterator(segments, b, node, BUCKET_COUNT);
+        }
+
+        // Buckets below SPLIT have been split at this level and take one
+        // more bit of the hash.
+        size_type address_helper(const hash_map_key_hash& h) const noexcept {
+            std::uint64_t low = std::uint64_t(INITIAL_BUCKETS) << LEVEL;
+            size_type b = static_cast<size_type>(h.first & (low - 1));
+            if (b < SPLIT)
+                b = static_cast<size_type>(h.first & (2 * low - 1));
+            return b;
+        }
+
+        node_type* find_node_helper(size_type b, const key_type& key, const hash_map_key_hash& h) const {
+            for (node_type* node = bucket_helper(b); node != nullptr; node = node->next) {
+                if (node->hash.first == h.first && node->hash.second == h.second
+                    && key_equal(node->value()->first, key))
+                    return node;
+            }
+            return nullptr;
+        }
+
+        /**
+         *  Splits the bucket at the split pointer into itself and a new
+         *  bucket at the end, keeping the order of both chains, and advances
+         *  the pointer. The new bucket's segment is allocated first, so a
+         *  throw leaves the map as it was.
+         */
+        void split_bucket_helper() {
+            std::uint64_t low = std::uint64_t(INITIAL_BUCKETS) << LEVEL;
+            if (2 * low > MAX_BUCKETS)
+                return;
+            size_type target = BUCKET_COUNT;
+            ensure_segment_helper(target);
+            node_type* node = bucket_helper(SPLIT);
+            node_type** stay = &bucket_helper(SPLIT);
+            node_type** move = &bucket_helper(target);
+            while (node != nullptr) {
+                node_type* next = node->next;
+                if (node->hash.first & low) {
+                    *move = node;
+                    move = &node->next;
+                } else {
+                    *stay = node;
+                    stay = &node->next;
+                }
+                node = next;
+            }
+            *stay = nullptr;
+            *move = nullptr;
+            BUCKET_COUNT++;
+            if (++SPLIT == low) {
+                LEVEL++;
+                SPLIT = 0;
+            }
+        }
+
+        // Splits until the elements plus incoming fit the load factor.
+        void check_load_factor(size_type incoming) {
+            while ((float)(NOT_NULL_SIZE + incoming) > LOAD_FACTOR * (float)BUCKET_COUNT) {
+                size_type buckets = BUCKET_COUNT;
+                split_bucket_helper();
+                if (BUCKET_COUNT == buckets)
+                    return;
+            }
+        }
+
+        template<typename... _Args>
+        std::pair<iterator, bool> try_emplace_helper(const key_type& k, _Args&&... args) {
+            if (BUCKET_COUNT == 0) {
+                ensure_segment_helper(0);
+                BUCKET_COUNT = INITIAL_BUCKETS;
+            }
+            hash_map_key_hash h = hash_key(firstHash, secondHash, k);
+            size_type b = address_helper(h);
+            node_type* found = find_node_helper(b, k, h);
+            if (found != nullptr)
+                return {make_iterator(b, found), false};
+            check_load_factor(1);
+            b = address_helper(h);
+            node_type* node = create_node_helper(h, std::piecewise_construct, std::forward_as_tuple(k),
+                                                 std::forward_as_tuple(std::forward<_Args>(args)...));
+            node->next = bucket_helper(b);
+            bucket_helper(b) = node;
+            NOT_NULL_SIZE++;
+            return {make_iterator(b, node), true};
+        }
+
+        // Unlinks and destroys node from bucket b.
+        void erase_node_helper(size_type b, node_type* node) noexcept {
+            node_type** link = &bucket_helper(b);
+            while (*link != node)
+                link = &(*link)->next;
+            *link = node->next;
+            destroy_node_helper(node);
+            NOT_NULL_SIZE--;
+        }
+
+    public:
+        /// Default constructor. The first insert allocates the buckets.
+        linear_hash_map() {}
+
+        explicit linear_hash_map(const allocator_type& a)
+        : node_allocator(a), segment_allocator(a), directory_allocator(a) {}
+
+        /// Copy constructor.
+        linear_hash_map(const linear_hash_map& other)
+        : linear_hash_map(other, alloc_traits::select_on_container_copy_construction(other.get_allocator())) {}
+
+        /// Copy constructor with allocator argument.
+        linear_hash_map(const linear_hash_map& other, const allocator_type& a)
+        : LOAD_FACTOR(other.LOAD_FACTOR), firstHash(other.firstHash), secondHash(other.secondHash),
+          key_equal(other.key_equal), node_allocator(a), segment_allocator(a), directory_allocator(a) {
+            copy_elements_helper(other);
+        }
+
+        /// Move constructor.
+        linear_hash_map(linear_hash_map&& other)
+        : LOAD_FACTOR(other.LOAD_FACTOR), firstHash(std::move(other.firstHash)),
+          secondHash(std::move(other.secondHash)), key_equal(std::move(other.key_equal)),
+          node_allocator(std::move(other.node_allocator)), segment_allocator(std::move(other.segment_allocator)),
+          directory_allocator(std::move(other.directory_allocator)) {
+            steal_elements_helper(other);
+        }
+
+        /**
+         *  @brief  Move constructor with allocator argument.
+         *
+         *  The memory of @a other is adopted only if its allocator compares
+         *  equal to @a a; otherwise its elements are moved one by one.
+         */
+        linear_hash_map(linear_hash_map&& other, const allocator_type& a)
+        : LOAD_FACTOR(other.LOAD_FACTOR), firstHash(other.firstHash), secondHash(other.secondHash),
+          key_equal(other.key_equal), node_allocator(a), segment_allocator(a), directory_allocator(a) {
+            this->move_construct_helper(other);
+        }
+
+        /// Builds a %linear_hash_map from an initializer_list.
+        linear_hash_map(std::initializer_list<value_type> l) {
+            this->insert(l);
+        }
+
+        ~linear_hash_map() {
+            release_helper();
+        }
+
+        /// Copy assignment operator.
+        linear_hash_map& operator=(const linear_hash_map& other) {
+            return this->copy_assign_helper(other);
+        }
+
+        /// Move assignment operator.
+        linear_hash_map& operator=(linear_hash_map&& other) {
+            return this->move_assign_helper(std::move(other));
+        }
+
+        ///  Returns the allocator object used by the %linear_hash_map.
+        allocator_type get_allocator() const noexcept {
+            return allocator_type(node_allocator);
+        }
+
+        ///  Returns the size of the %linear_hash_map.
+        size_type size() const noexcept {
+            return NOT_NULL_SIZE;
+        }
+
+        ///  Returns the number of buckets of the %linear_hash_map.
+        size_type max_size() const noexcept {
+            return BUCKET_COUNT;
+        }
+
+        iterator begin() noexcept {
+            iterator it = make_iterator(0, nullptr);
+            it.seek_helper();
+            return it;
+        }
+
+        const_iterator begin() const noexcept {
+            iterator it = make_iterator(0, nullptr);
+            it.seek_helper();
+            return it;
+        }
+
+        iterator end() noexcept {
+            return make_iterator(BUCKET_COUNT, nullptr);
+        }
+
+        const_iterator end() const noexcept {
+            return make_iterator(BUCKET_COUNT, nullptr);
+        }
+
+        /**
+         *  @brief Erases elements according to the provided key.
+         *  @param  key  Key of element to be erased.
+         *  @return  The number of elements erased.
+         */
+        size_type erase(const key_type& key) {
+            if (BUCKET_COUNT == 0)
+                return 0;
+            hash_map_key_hash h = hash_key(firstHash, secondHash, key);
+            size_type b = address_helper(h);
+            node_type* node = find_node_helper(b, key, h);
+            if (node == nullptr)
+                return 0;
+            erase_node_helper(b, node);
+            return 1;
+        }
+
+        /**
+         *  @brief Erases an element from a %linear_hash_map.
+         *  @param  position  An iterator pointing to the element to be erased.
+         *  @return  An iterator pointing to the next element.
+         */
+        iterator erase(const_iterator position) {
+            iterator next = make_iterator(position.bucket, position.node);
+            ++next;
+            erase_node_helper(position.bucket, position.node);
+            return next;
+        }
+
+        /// Erases all elements and releases every bucket.
+        void clear() noexcept {
+            release_helper();
+        }
+
+        //@{
+        /**
+         *  @brief Tries to locate an element in a %linear_hash_map.
+         *  @param  key  Key to be located.
+         *  @return  Iterator pointing to sought-after element, or end() if not
+         *           found.
+         */
+        iterator find(const key_type& key) {
+            if (BUCKET_COUNT == 0)
+                return end();
+            hash_map_key_hash h = hash_key(firstHash, secondHash, key);
+            size_type b = address_helper(h);
+            node_type* node = find_node_helper(b, key, h);
+            return node == nullptr ? end() : make_iterator(b, node);
+        }
+
+        const_iterator find(const key_type& key) const {
+            return const_cast<linear_hash_map*>(this)->find(key);
+        }
+        //@}
+
+        /// Returns the average number of elements per bucket.
+        float load_factor() const noexcept {
+            return BUCKET_COUNT == 0 ? 0 : (float)NOT_NULL_SIZE / (float)BUCKET_COUNT;
+        }
+
+        /// Returns the average chain length the %linear_hash_map keeps below.
+        float max_load_factor() const noexcept {
+            return LOAD_FACTOR;
+        }
+
+        /// Changes the maximum load factor, splitting buckets to meet it.
+        void max_load_factor(float z) {
+            LOAD_FACTOR = z;
+            if (BUCKET_COUNT != 0)
+                check_load_factor(0);
+        }
+
+        /**
+         *  @brief  Returns the bytes held by the %linear_hash_map.
+         *
+         *  Segments and the segment directory count as table. Bucket heads
+         *  of segments not yet in use and unused directory entries are
+         *  slack.
+         */
+        hash_map_memory_usage memory_usage() const noexcept {
+            hash_map_memory_usage usage{0, 0, 0, 0, 0, table_backing::allocator};
+            usage.table = SEGMENT_COUNT * SEGMENT_SIZE * sizeof(node_type*) + DIRECTORY_CAPACITY * sizeof(node_type**);
+            usage.nodes = NOT_NULL_SIZE * sizeof(node_type);
+            usage.slack = (SEGMENT_COUNT * SEGMENT_SIZE - BUCKET_COUNT) * sizeof(node_type*)
+                          + (DIRECTORY_CAPACITY - SEGMENT_COUNT) * sizeof(node_type**);
+            return usage;
+        }
+
+        /// Splits buckets until @a n elements fit the load factor.
+        void reserve(size_type n) {
+            if (BUCKET_COUNT == 0) {
+                ensure_segment_helper(0);
+                BUCKET_COUNT = INITIAL_BUCKETS;
+            }
+            if (n > NOT_NULL_SIZE)
+                check_load_factor(n - NOT_NULL_SIZE);
+        }
+    };
+
+    template<typename K, typename T, class FirstHash, class SecondHash, typename Pred, typename Alloc>
+    constexpr std::size_t linear_hash_map<K, T, FirstHash, SecondHash, Pred, Alloc>::SEGMENT_SIZE;
+
+    template<typename K, typename T, class FirstHash, class SecondHash, typename Pred, typename Alloc>
+    constexpr std::size_t linear_hash_map<K, T, FirstHash, SecondHash, Pred, Alloc>::INITIAL_BUCKETS;
+
+    template<typename K, typename T, class FirstHash, class SecondHash, typename Pred, typename Alloc>
+    constexpr std::uint64_t linear_hash_map<K, T, FirstHash, SecondHash, Pred, Alloc>::MAX_BUCKETS;
+
+} // namespace fefu
+
+
+
+#endif //HASHMAP_LINEAR_HASH_MAP_H
@@ -0,0 +1,632 @@
+#ifndef HASHMAP_ORDERED_HASH_MAP_H
+#define HASHMAP_ORDERED_HASH_MAP_H
+
+
+#pragma once
+
+#include "hash_map.h"
+
+#include <iterator>
+#include <stdexcept>
+
+namespace fefu
+{
+
+    /**
+     *  Element of an %ordered_hash_map, kept in the dense entry array in
+     *  insertion order. Erased entries stay behind as holes with alive
+     *  cleared until the next rehash compacts the array.
+     */
+    template<typename Value>
+    struct ordered_hash_map_entry {
+        hash_map_key_hash hash;
+        bool alive;
+        typename std::aligned_storage<sizeof(Value), alignof(Value)>::type storage;
+
+        Value* value() noexcept {
+            return reinterpret_cast<Value*>(&storage);
+        }
+
+        const Value* value() const noexcept {
+            return reinterpret_cast<const Value*>(&storage);
+        }
+    };
+
+
+    /**
+     *  Iterator of an %ordered_hash_map. Scans the entry array front to
+     *  back, skipping holes, and hands out element pointers like the
+     *  %hash_map iterators.
+     */
+    template<typename ValueType>
+    class ordered_hash_map_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ValueType;
+        using difference_type = std::ptrdiff_t;
+        using reference = ValueType*;
+        using pointer = ValueType*;
+        using entry_type = ordered_hash_map_entry<typename std::remove_const<ValueType>::type>;
+
+        ordered_hash_map_iterator() noexcept {}
+
+        ordered_hash_map_iterator(entry_type* entries, size_t cur_index, size_t count) noexcept
+        : entries(entries), cur_index(cur_index), count(count) {}
+
+        template<typename U, typename = typename std::enable_if<std::is_same<const U, ValueType>::value>::type>
+        ordered_hash_map_iterator(const ordered_hash_map_iterator<U>& other) noexcept
+        : entries(other.entries), cur_index(other.cur_index), count(other.count) {}
+
+        reference operator*() const {
+            return entries[cur_index].value();
+        }
+        pointer operator->() const {
+            return **this;
+        }
+
+        // prefix ++
+        ordered_hash_map_iterator& operator++() {
+            cur_index++;
+            seek_helper();
+            return *this;
+        }
+        // postfix ++
+        ordered_hash_map_iterator operator++(int) {
+            ordered_hash_map_iterator old = *this;
+            ++(*this);
+            return old;
+        }
+
+        friend bool operator==(const ordered_hash_map_iterator& l_point, const ordered_hash_map_iterator& r_point) {
+            return l_point.entries == r_point.entries && l_point.cur_index == r_point.cur_index;
+        }
+        friend bool operator!=(const ordered_hash_map_iterator& l_point, const ordered_hash_map_iterator& r_point) {
+            return !(l_point == r_point);
+        }
+
+    private:
+        template<typename>
+        friend class ordered_hash_map_iterator;
+        template<typename, typename, class, class, typename, typename>
+        friend class ordered_hash_map;
+
+        void seek_helper() noexcept {
+            while (cur_index < count && !entries[cur_index].alive)
+                cur_index++;
+        }
+
+        entry_type* entries;
+        size_t cur_index;
+        size_t count;
+    };
+
+
+    /**
+     *  Open addressing map that remembers insertion order, laid out like
+     *  the compact dict of CPython 3.6. Elements are appended to a dense
+     *  entry array together with their hashes, and the probed table holds
+     *  only indices into that array. Index entries take 1, 2, 4 or 8 bytes,
+     *  whichever fits the entry capacity, so the table of a small map costs
+     *  a byte per slot. The table is probed slot by slot along the
+     *  double_hash_probe sequence of %hash_map.
+     *
+     *  Iteration is a linear scan of the entry array in insertion order,
+     *  which makes it deterministic across runs and builds. Every insert,
+     *  operator[] included, appends. Erasing leaves a hole; re-inserting an
+     *  erased key appends it at the end. Elements
+     *  move when the entry array grows or is compacted, which invalidates
+     *  references into the map.
+     */
+    template<typename K, typename T,
+            class FirstHash = FirstKeyHash<K>,
+            class SecondHash = SecondKeyHash<K>,
+            typename Pred = std::equal_to<K>,
+            typename Alloc = allocator<std::pair<const K, T>*>>
+    class ordered_hash_map : public hash_map_container_base<ordered_hash_map<K, T, FirstHash, SecondHash, Pred, Alloc>, K, T>
+    {
+    public:
+        using key_type = K;
+        using mapped_type = T;
+        using allocator_type = Alloc;
+        using value_type = std::pair<const key_type, mapped_type>;
+        using iterator = ordered_hash_map_iterator<value_type>;
+        using const_iterator = ordered_hash_map_iterator<const value_type>;
+        using size_type = std::size_t;
+
+    private:
+        using entry_type = typename iterator::entry_type;
+        using alloc_traits = std::allocator_traits<allocator_type>;
+        using entry_allocator_type = typename alloc_traits::template rebind_alloc<entry_type>;
+        using byte_allocator_type = typename alloc_traits::template rebind_alloc<unsigned char>;
+        using entry_alloc_traits = std::allocator_traits<entry_allocator_type>;
+        using byte_alloc_traits = std::allocator_traits<byte_allocator_type>;
+
+        // Size of the first table, allocated by the first insert.
+        static constexpr size_type INITIAL_SIZE = 37;
+
+        // Index entries: 0 is an empty slot, 1 an erased one, and i + 2
+        // refers to entry i.
+        static constexpr size_type EMPTY_INDEX = 0;
+        static constexpr size_type DELETED_INDEX = 1;
+
+        // Every used table slot refers to an entry below ENTRY_COUNT, and
+        // ENTRY_CAPACITY stays below SIZE * LOAD_FACTOR, so the entry
+        // array bounds the table load, tombstones included.
+        size_type SIZE = 0;
+        size_type NOT_NULL_SIZE = 0;
+        size_type ENTRY_COUNT = 0;
+        size_type ENTRY_CAPACITY = 0;
+        size_type INDEX_WIDTH = 1;
+        float LOAD_FACTOR = 0.7;
+        unsigned char* indices = nullptr;
+        entry_type* entries = nullptr;
+        FirstHash firstHash;
+        SecondHash secondHash;
+        Pred key_equal;
+        entry_allocator_type entry_allocator{allocator_type()};
+        byte_allocator_type byte_allocator{entry_allocator};
+
+        // Narrowest index entry that can name every entry of capacity.
+        static size_type index_width_helper(size_type capacity) noexcept {
+            if(capacity + 2 <= 0xFFu)
+                return 1;
+            if(capacity + 2 <= 0xFFFFu)
+                return 2;
+            if(capacity + 2 <= 0xFFFFFFFFu)
+                return 4;
+            return 8;
+        }
+
+        size_type index_helper(size_type x) const noexcept {
+            switch(INDEX_WIDTH) {
+                case 1: return indices[x];
+                case 2: return reinterpret_cast<const std::uint16_t*>(indices)[x];
+                case 4: return reinterpret_cast<const std::uint32_t*>(indices)[x];
+                default: return static_cast<size_type>(reinterpret_cast<const std::uint64_t*>(indices)[x]);
+            }
+        }
+
+        void set_index_helper(size_type x, size_type index) noexcept {
+            switch(INDEX_WIDTH) {
+                case 1: indices[x] = static_cast<unsigned char>(index); break;
+                case 2: reinterpret_cast<std::uint16_t*>(indices)[x] = static_cast<std::uint16_t>(index); break;
+                case 4: reinterpret_cast<std::uint32_t*>(indices)[x] = static_cast<std::uint32_t>(index); break;
+                default: reinterpret_cast<std::uint64_t*>(indices)[x] = index; break;
+            }
+        }
+
+        void destroy_entries_helper(entry_type* array, size_type count) noexcept {
+            for(size_type i = 0; i < count; i++) {
+                if(array[i].alive)
+                    entry_alloc_traits::destroy(entry_allocator, array[i].value());
+            }
+        }
+
+        void release_helper() noexcept {
+            if(entries == nullptr)
+                return;
+            destroy_entries_helper(entries, ENTRY_COUNT);
+            entry_alloc_traits::deallocate(entry_allocator, entries, ENTRY_CAPACITY);
+            byte_alloc_traits::deallocate(byte_allocator, indices, SIZE * INDEX_WIDTH);
+            entries = nullptr;
+            indices = nullptr;
+            SIZE = 0;
+            NOT_NULL_SIZE = 0;
+            ENTRY_COUNT = 0;
+            ENTRY_CAPACITY = 0;
+            INDEX_WIDTH = 1;
+        }
+
+        void steal_elements_helper(ordered_hash_map& other) noexcept {
+            SIZE = other.SIZE;
+            NOT_NULL_SIZE = other.NOT_NULL_SIZE;
+            ENTRY_COUNT = other.ENTRY_COUNT;
+            ENTRY_CAPACITY = other.ENTRY_CAPACITY;
+            INDEX_WIDTH = other.INDEX_WIDTH;
+            indices = other.indices;
+            entries = other.entries;
+            other.SIZE = 0;
+            other.NOT_NULL_SIZE = 0;
+            other.ENTRY_COUNT = 0;
+            other.ENTRY_CAPACITY = 0;
+            other.INDEX_WIDTH = 1;
+            other.indices = nullptr;
+            other.entries = nullptr;
+        }
+
+        iterator make_iterator(size_type i) {
+            return iterator(entries, i, ENTRY_COUNT);
+        }
+
+        const_iterator make_iterator(size_type i) const {
+            return const_iterator(entries, i, ENTRY_COUNT);
+        }
+
+        // Makes room for one more entry: grows the arrays, or only compacts
+        // them when at least half of the entries are holes.
+        void check_load_factor() {
+            if(ENTRY_COUNT < ENTRY_CAPACITY)
+                return;
+            if(SIZE == 0)
+                rehash(INITIAL_SIZE);
+            else if(NOT_NULL_SIZE < ENTRY_CAPACITY / 2)
+                rehash(SIZE);
+            else
+                rehash(2 * SIZE);
+        }
+
+        // Returns the slot of key and true, or the slot an insert of key
+        // should use and false. SIZE stands for no free slot.
+        std::pair<size_type, bool> find_position_helper(const key_type& key, const hash_map_key_hash& h) const {
+            if (SIZE == 0)
+                return {SIZE, false};
+            double_hash_probe::sequence probe(h, SIZE);
+            size_type free_slot = SIZE;
+            for (size_type i = 0; i < SIZE; i++, probe.next()) {
+                size_type x = probe.group();
+                size_type index = index_helper(x);
+                if (index == EMPTY_INDEX)
+                    return {free_slot == SIZE ? x : free_slot, false};
+                if (index == DELETED_INDEX) {
+                    if (free_slot == SIZE)
+                        free_slot = x;
+                } else {
+                    const entry_type& entry = entries[index - 2];
+                    if (entry.hash.first == h.first && entry.hash.second == h.second
+                        && key_equal(entry.value()->first, key))
+                        return {x, true};
+                }
+            }
+            return {free_slot, false};
+        }
+
+        // Probes for an empty slot of the current table only.
+        size_type find_free_slot_helper(const hash_map_key_hash& h) const noexcept {
+            double_hash_probe::sequence probe(h, SIZE);
+            for (size_type i = 0; i < SIZE; i++, probe.next()) {
+                size_type x = probe.group();
+                if (index_helper(x) == EMPTY_INDEX)
+                    return x;
+            }
+            return SIZE;
+        }
+
+        template<typename... _Args>
+        std::pair<iterator, bool> try_emplace_helper(const key_type& k, _Args&&... args) {
+            hash_map_key_hash h = hash_key(firstHash, secondHash, k);
+            auto pos = find_position_helper(k, h);
+            if (pos.second)
+                return {make_iterator(index_helper(pos.first) - 2), false};
+            if (ENTRY_COUNT == ENTRY_CAPACITY) {
+                check_load_factor();
+                pos = find_position_helper(k, h);
+            }
+            while (pos.first == SIZE) {
+                rehash(2 * SIZE);
+                pos = find_position_helper(k, h);
+            }
+            entry_type& entry = entries[ENTRY_COUNT];
+            entry_alloc_traits::construct(entry_allocator, entry.value(), std::piecewise_construct,
+                                          std::forward_as_tuple(k),
+                                          std::forward_as_tuple(std::forward<_Args>(args)...));
+            entry.hash = h;
+            entry.alive = true;
+            set_index_helper(pos.first, ENTRY_COUNT + 2);
+            NOT_NULL_SIZE++;
+            return {make_iterator(ENTRY_COUNT++), true};
+        }
+
+        void erase_slot_helper(size_type x) {
+            entry_type& entry = entries[index_helper(x) - 2];
+            entry_alloc_traits::destroy(entry_allocator, entry.value());
+            entry.alive = false;
+            set_index_helper(x, DELETED_INDEX);
+            NOT_NULL_SIZE--;
+        }
+
+        // Finds the table slot that refers to entry i.
+        size_type entry_slot_helper(size_type i) const noexcept {
+            double_hash_probe::sequence probe(entries[i].hash, SIZE);
+            while (index_helper(probe.group()) != i + 2)
+                probe.next();
+            return probe.group();
+        }
+
+        friend class hash_map_container_base<ordered_hash_map, K, T>;
+
+        void swap_helper(ordered_hash_map& x, bool allocators) {
+            std::swap(SIZE, x.SIZE);
+            std::swap(NOT_NULL_SIZE, x.NOT_NULL_SIZE);
+            std::swap(ENTRY_COUNT, x.ENTRY_COUNT);
+            std::swap(ENTRY_CAPACITY, x.ENTRY_CAPACITY);
+            std::swap(INDEX_WIDTH, x.INDEX_WIDTH);
+            std::swap(LOAD_FACTOR, x.LOAD_FACTOR);
+            std::swap(indices, x.indices);
+            std::swap(entries, x.entries);
+            std::swap(firstHash, x.firstHash);
+            std::swap(secondHash, x.secondHash);
+            std::swap(key_equal, x.key_equal);
+            if(allocators) {
+                std::swap(entry_allocator, x.entry_allocator);
+                std::swap(byte_allocator, x.byte_allocator);
+            }
+        }
+
+    public:
+        /// Default constructor. The first insert allocates the arrays.
+        ordered_hash_map() {}
+
+        /**
+         *  @brief  Default constructor creates no elements.
+         *  @param n  Minimal initial number of buckets.
+         */
+        explicit ordered_hash_map(size_type n) {
+            if(n > 0)
+                rehash(n);
+        }
+
+        explicit ordered_hash_map(const allocator_type& a)
+        : entry_allocator(a), byte_allocator(a) {}
+
+        /// Copy constructor. The copy is compacted and keeps the order.
+        ordered_hash_map(const ordered_hash_map& other)
+        : ordered_hash_map(other, alloc_traits::select_on_container_copy_construction(other.get_allocator())) {}
+
+        /// Copy constructor with allocator argument.
+        ordered_hash_map(const ordered_hash_map& other, const allocator_type& a)
+        : LOAD_FACTOR(other.LOAD_FACTOR), firstHash(other.firstHash), secondHash(other.secondHash),
+          key_equal(other.key_equal), entry_allocator(a), byte_allocator(a) {
+            if(other.empty())
+                return;
+            rehash(other.SIZE);
+            try {
+                for(auto it = other.begin(); it != other.end(); ++it)
+                    try_emplace_helper(it->first, it->second);
+            } catch(...) {
+                release_helper();
+                throw;
+            }
+        }
+
+        /// Move constructor.
+        ordered_hash_map(ordered_hash_map&& other)
+        : LOAD_FACTOR(other.LOAD_FACTOR), firstHash(std::move(other.firstHash)),
+          secondHash(std::move(other.secondHash)), key_equal(std::move(other.key_equal)),
+          entry_allocator(std::move(other.entry_allocator)), byte_allocator(std::move(other.byte_allocator)) {
+            steal_elements_helper(other);
+        }
+
+        /**
+         *  @brief  Move constructor with allocator argument.
+         *
+         *  The memory of @a other is adopted only if its allocator compares
+         *  equal to @a a; otherwise its elements are moved one by one.
+         */
+        ordered_hash_map(ordered_hash_map&& other, const allocator_type& a)
+        : LOAD_FACTOR(other.LOAD_FACTOR), firstHash(other.firstHash), secondHash(other.secondHash),
+          key_equal(other.key_equal), entry_allocator(a), byte_allocator(a) {
+            this->move_construct_helper(other);
+        }
+
+        /// Builds an %ordered_hash_map from an initializer_list, in list order.
+        ordered_hash_map(std::initializer_list<value_type> l) {
+            this->insert(l);
+        }
+
+        ~ordered_hash_map() {
+            release_helper();
+        }
+
+        /// Copy assignment operator.
+        ordered_hash_map& operator=(const ordered_hash_map& other) {
+            return this->copy_assign_helper(other);
+        }
+
+        /// Move assignment operator.
+        ordered_hash_map& operator=(ordered_hash_map&& other) {
+            return this->move_assign_helper(std::move(other));
+        }
+
+        ///  Returns the allocator object used by the %ordered_hash_map.
+        allocator_type get_allocator() const noexcept {
+            return allocator_type(entry_allocator);
+        }
+
+        ///  Returns the size of the %ordered_hash_map.
+        size_type size() const noexcept {
+            return NOT_NULL_SIZE;
+        }
+
+        ///  Returns the number of slots of the %ordered_hash_map.
+        size_type max_size() const noexcept {
+            return SIZE;
+        }
+
+        /// Returns the bytes of one index entry of the table.
+        size_type index_width() const noexcept {
+            return INDEX_WIDTH;
+        }
+
+        iterator begin() noexcept {
+            iterator it = make_iterator(0);
+            it.seek_helper();
+            return it;
+        }
+
+        const_iterator begin() const noexcept {
+            const_iterator it = make_iterator(0);
+            it.seek_helper();
+            return it;
+        }
+
+        iterator end() noexcept {
+            return make_iterator(ENTRY_COUNT);
+        }
+
+        const_iterator end() const noexcept {
+            return make_iterator(ENTRY_COUNT);
+        }
+
+        /**
+         *  @brief Erases elements according to the provided key.
+         *  @param  key  Key of element to be erased.
+         *  @return  The number of elements erased.
+         */
+        size_type erase(const key_type& key) {
+            auto pos = find_position_helper(key, hash_key(firstHash, secondHash, key));
+            if (!pos.second)
+                return 0;
+            erase_slot_helper(pos.first);
+            return 1;
+        }
+
+        /**
+         *  @brief Erases an element from an %ordered_hash_map.
+         *  @param  position  An iterator pointing to the element to be erased.
+         *  @return  An iterator pointing to the next element in order.
+         */
+        iterator erase(const_iterator position) {
+            erase_slot_helper(entry_slot_helper(position.cur_index));
+            iterator next = make_iterator(position.cur_index + 1);
+            next.seek_helper();
+            return next;
+        }
+
+        /// Erases all elements and releases both arrays.
+        void clear() noexcept {
+            release_helper();
+        }
+
+        //@{
+        /**
+         *  @brief Tries to locate an element in an %ordered_hash_map.
+         *  @param  key  Key to be located.
+         *  @return  Iterator pointing to sought-after element, or end() if not
+         *           found.
+         */
+        iterator find(const key_type& key) {
+            auto pos = find_position_helper(key, hash_key(firstHash, secondHash, key));
+            return pos.second ? make_iterator(index_helper(pos.first) - 2) : end();
+        }
+
+        const_iterator find(const key_type& key) const {
+            auto pos = find_position_helper(key, hash_key(firstHash, secondHash, key));
+            return pos.second ? make_iterator(index_helper(pos.first) - 2) : end();
+        }
+        //@}
+
+        /// Returns the average number of elements per slot.
+        float load_factor() const noexcept {
+            return SIZE == 0 ? 0 : (float)NOT_NULL_SIZE / (float)SIZE;
+        }
+
+        /// Returns the load factor the %ordered_hash_map keeps below.
+        float max_load_factor() const noexcept {
+            return LOAD_FACTOR;
+        }
+
+        /// Changes the maximum load factor. z must lie in (0, 1).
+        void max_load_factor(float z) {
+            LOAD_FACTOR = z;
+            if(SIZE != 0 && (float)ENTRY_CAPACITY > (float)SIZE * LOAD_FACTOR)
+                rehash(SIZE);
+        }
+
+        /**
+         *  @brief  Returns the bytes held by the %ordered_hash_map.
+         *
+         *  The index array counts as table and the whole entry array as
+         *  nodes. Empty index entries, entry capacity and holes are slack;
+         *  holes and erased index entries are tombstones.
+         */
+        hash_map_memory_usage memory_usage() const noexcept {
+            hash_map_memory_usage usage{0, 0, 0, 0, 0, table_backing::allocator};
+            size_type erased = 0;
+            for(size_type x = 0; x < SIZE; x++)
+                erased += index_helper(x) == DELETED_INDEX;
+            usage.table = SIZE * INDEX_WIDTH;
+            usage.nodes = ENTRY_CAPACITY * sizeof(entry_type);
+            usage.slack = (SIZE - NOT_NULL_SIZE) * INDEX_WIDTH + (ENTRY_CAPACITY - NOT_NULL_SIZE) * sizeof(entry_type);
+            usage.tombstones = erased * INDEX_WIDTH + (ENTRY_COUNT - NOT_NULL_SIZE) * sizeof(entry_type);
+            return usage;
+        }
+
+        /**
+         *  @brief  Rebuilds the table with at least @a n slots.
+         *
+         *  Live entries are moved to a new, compacted entry array in their
+         *  order, and the index table is rebuilt from their cached hashes
+         *  without hashing any key again.
+         */
+        void rehash(size_type n) {
+            size_type need = (size_type)std::ceil((float)(NOT_NULL_SIZE + 1) / LOAD_FACTOR) + 1;
+            size_type new_size = n < need ? need : n;
+            size_type new_capacity = (size_type)((float)new_size * LOAD_FACTOR);
+            if(new_capacity <= NOT_NULL_SIZE)
+                new_capacity = NOT_NULL_SIZE + 1;
+            if(new_size <= new_capacity)
+                new_size = new_capacity + 1;
+
+            // Both arrays are allocated before any entry moves, and entries
+            // are moved only when that cannot throw, so a throw leaves the
+            // map as it was.
+            size_type new_width = index_width_helper(new_capacity);
+            entry_type* new_entries = entry_alloc_traits::allocate(entry_allocator, new_capacity);
+            unsigned char* new_indices;
+            try {
+                new_indices = byte_alloc_traits::allocate(byte_allocator, new_size * new_width);
+            } catch(...) {
+                entry_alloc_traits::deallocate(entry_allocator, new_entries, new_capacity);
+                throw;
+            }
+            size_type moved = 0;
+            try {
+                for(size_type i = 0; i < ENTRY_COUNT; i++) {
+                    if(!entries[i].alive)
+                        continue;
+                    entry_alloc_traits::construct(entry_allocator, new_entries[moved].value(),
+                                                  std::move_if_noexcept(*entries[i].value()));
+                    new_entries[moved].hash = entries[i].hash;
+                    new_entries[moved].alive = true;
+                    moved++;
+                }
+            } catch(...) {
+                destroy_entries_helper(new_entries, moved);
+                entry_alloc_traits::deallocate(entry_allocator, new_entries, new_capacity);
+                byte_alloc_traits::deallocate(byte_allocator, new_indices, new_size * new_width);
+                throw;
+            }
+
+            // The probe sequences cover the table, which has more slots than
+            // entries, so every entry finds an empty slot.
+            size_type PAST_SIZE = SIZE;
+            size_type past_width = INDEX_WIDTH;
+            unsigned char* past_indices = indices;
+            indices = new_indices;
+            SIZE = new_size;
+            INDEX_WIDTH = new_width;
+            std::fill(indices, indices + new_size * new_width, 0);
+            for(size_type i = 0; i < moved; i++)
+                set_index_helper(find_free_slot_helper(new_entries[i].hash), i + 2);
+
+            if(entries != nullptr) {
+                destroy_entries_helper(entries, ENTRY_COUNT);
+                entry_alloc_traits::deallocate(entry_allocator, entries, ENTRY_CAPACITY);
+                byte_alloc_traits::deallocate(byte_allocator, past_indices, PAST_SIZE * past_width);
+            }
+            entries = new_entries;
+            ENTRY_COUNT = moved;
+            ENTRY_CAPACITY = new_capacity;
+        }
+
+        /// Prepares the %ordered_hash_map for @a n elements.
+        void reserve(size_type n) {
+            rehash(ceil((float)n / (float)max_load_factor()));
+        }
+    };
+
+} // namespace fefu
+
+
+
+#endif //HASHMAP_ORDERED_HASH_MAP_H
@@ -0,0 +1,691 @@
+#ifndef HASHMAP_SOA_HASH_MAP_H
+#define HASHMAP_SOA_HASH_MAP_H
+
+
+#pragma once
+
+#include "hash_map.h"
+
+#include <iterator>
+#include <stdexcept>
+
+namespace fefu
+{
+
+    /**
+     *  Iterator of a %soa_hash_map. Keys and mapped values sit in separate
+     *  arrays, so there is no stored pair to point to: dereferencing yields
+     *  a pair of references into the two arrays.
+     */
+    template<typename K, typename T>
+    class soa_hash_map_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<const K, typename std::remove_const<T>::type>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::pair<const K&, T&>;
+
+        // Keeps the pair of references alive for operator->.
+        struct pointer {
+            reference ref;
+            reference* operator->() noexcept {
+                return &ref;
+            }
+        };
+
+        soa_hash_map_iterator() noexcept {}
+
+        soa_hash_map_iterator(const slot_state* states, const K* keys, T* values,
+                              size_t cur_index, size_t size) noexcept
+        : states(states), keys(keys), values(values), cur_index(cur_index), size(size) {}
+
+        template<typename U, typename = typename std::enable_if<std::is_same<const U, T>::value>::type>
+        soa_hash_map_iterator(const soa_hash_map_iterator<K, U>& other) noexcept
+        : states(other.states), keys(other.keys), values(other.values),
+          cur_index(other.cur_index), size(other.size) {}
+
+        reference operator*() const {
+            return {keys[cur_index], values[cur_index]};
+        }
+        pointer operator->() const {
+            return {**this};
+        }
+
+        // prefix ++
+        soa_hash_map_iterator& operator++() {
+            cur_index++;
+            seek_helper();
+            return *this;
+        }
+        // postfix ++
+        soa_hash_map_iterator operator++(int) {
+            soa_hash_map_iterator old = *this;
+            ++(*this);
+            return old;
+        }
+
+        friend bool operator==(const soa_hash_map_iterator& l_point, const soa_hash_map_iterator& r_point) {
+            return l_point.states == r_point.states && l_point.cur_index == r_point.cur_index;
+        }
+        friend bool operator!=(const soa_hash_map_iterator& l_point, const soa_hash_map_iterator& r_point) {
+            return !(l_point == r_point);
+        }
+
+    private:
+        template<typename, typename>
+        friend class soa_hash_map_iterator;
+        template<typename, typename, class, class, typename, typename>
+        friend class soa_hash_map;
+
+        void seek_helper() noexcept {
+            while (cur_index < size && states[cur_index] != slot_state::full)
+                cur_index++;
+        }
+
+        const slot_state* states;
+        const K* keys;
+        T* values;
+        size_t cur_index;
+        size_t size;
+    };
+
+
+    /**
+     *  Open addressing map with a structure-of-arrays layout: slot x keeps
+     *  its state in states[x], its key in keys[x] and its mapped value in
+     *  values[x]. Probing reads only the state and key arrays, so a cache
+     *  line holds as many candidates as keys fit in it, and scans over the
+     *  mapped values stream one contiguous array (see for_each_value()).
+     *
+     *  Slots are probed along double_hash_probe, one slot at a time where
+     *  %hash_map steps over groups. Nothing but keys is stored, so hashes
+     *  are recomputed when the table grows. Elements move on rehash, which
+     *  invalidates references into the map.
+     */
+    template<typename K, typename T,
+            class FirstHash = FirstKeyHash<K>,
+            class SecondHash = SecondKeyHash<K>,
+            typename Pred = std::equal_to<K>,
+            typename Alloc = allocator<std::pair<const K, T>*>>
+    class soa_hash_map : public hash_map_container_base<soa_hash_map<K, T, FirstHash, SecondHash, Pred, Alloc>, K, T>
+    {
+    public:
+        using key_type = K;
+        using mapped_type = T;
+        using allocator_type = Alloc;
+        using value_type = std::pair<const key_type, mapped_type>;
+        using iterator = soa_hash_map_iterator<key_type, mapped_type>;
+        using const_iterator = soa_hash_map_iterator<key_type, const mapped_type>;
+        using size_type = std::size_t;
+
+    private:
+        // Alloc is rebound for each of the three arrays.
+        using alloc_traits = std::allocator_traits<allocator_type>;
+        using state_allocator_type = typename alloc_traits::template rebind_alloc<slot_state>;
+        using key_allocator_type = typename alloc_traits::template rebind_alloc<key_type>;
+        using value_allocator_type = typename alloc_traits::template rebind_alloc<mapped_type>;
+        using state_alloc_traits = std::allocator_traits<state_allocator_type>;
+        using key_alloc_traits = std::allocator_traits<key_allocator_type>;
+        using value_alloc_traits = std::allocator_traits<value_allocator_type>;
+        using index_allocator_type = typename alloc_traits::template rebind_alloc<size_type>;
+        using index_alloc_traits = std::allocator_traits<index_allocator_type>;
+
+        // Size of the first table, allocated by the first insert.
+        static constexpr size_type INITIAL_SIZE = 37;
+
+        size_type SIZE = 0;
+        size_type NOT_NULL_SIZE = 0;
+        size_type DELETED_SIZE = 0;
+        float LOAD_FACTOR = 0.7;
+        slot_state* states = nullptr;
+        key_type* keys = nullptr;
+        mapped_type* values = nullptr;
+        FirstHash firstHash;
+        SecondHash secondHash;
+        Pred key_equal;
+        state_allocator_type state_allocator{allocator_type()};
+        key_allocator_type key_allocator{state_allocator};
+        value_allocator_type value_allocator{state_allocator};
+
+        // Allocates the arrays of an empty table of n slots. Only states are
+        // initialised, keys and values are constructed as slots fill.
+        void allocate_arrays_helper(size_type n) {
+            SIZE = n < 2 ? 2 : n;
+            states = state_alloc_traits::allocate(state_allocator, SIZE);
+            try {
+                keys = key_alloc_traits::allocate(key_allocator, SIZE);
+                try {
+                    values = value_alloc_traits::allocate(value_allocator, SIZE);
+                } catch(...) {
+                    key_alloc_traits::deallocate(key_allocator, keys, SIZE);
+                    throw;
+                }
+            } catch(...) {
+                state_alloc_traits::deallocate(state_allocator, states, SIZE);
+                states = nullptr;
+                keys = nullptr;
+                SIZE = 0;
+                throw;
+            }
+            for(size_type x = 0; x < SIZE; x++)
+                states[x] = slot_state::empty;
+        }
+
+        void deallocate_arrays_helper(slot_state* old_states, key_type* old_keys,
+                                      mapped_type* old_values, size_type n) {
+            if(old_states == nullptr)
+                return;
+            value_alloc_traits::deallocate(value_allocator, old_values, n);
+            key_alloc_traits::deallocate(key_allocator, old_keys, n);
+            state_alloc_traits::deallocate(state_allocator, old_states, n);
+        }
+
+        void destroy_slot_helper(size_type x) {
+            value_alloc_traits::destroy(value_allocator, values + x);
+            key_alloc_traits::destroy(key_allocator, keys + x);
+        }
+
+        void destroy_elements_helper() {
+            for(size_type x = 0; x < SIZE; x++) {
+                if(states[x] == slot_state::full)
+                    destroy_slot_helper(x);
+            }
+        }
+
+        // Builds each full old slot of from at its new slot in to, keeping
+        // from intact unless the moves cannot throw. On an exception the
+        // copies made so far are destroyed.
+        template<typename Allocator, typename U>
+        static void transfer_array_helper(Allocator& allocator, U* to, U* from, const slot_state* past_states,
+                                          const size_type* target, size_type n) {
+            size_type i = 0;
+            try {
+                for(; i < n; i++) {
+                    if(past_states[i] == slot_state::full)
+                        std::allocator_traits<Allocator>::construct(allocator, to + target[i],
+                                                                    std::move_if_noexcept(from[i]));
+                }
+            } catch(...) {
+                destroy_array_helper(allocator, to, past_states, target, i);
+                throw;
+            }
+        }
+
+        template<typename Allocator, typename U>
+        static void destroy_array_helper(Allocator& allocator, U* to, const slot_state* past_states,
+                                         const size_type* target, size_type n) noexcept {
+            for(size_type i = 0; i < n; i++) {
+                if(past_states[i] == slot_state::full)
+                    std::allocator_traits<Allocator>::destroy(allocator, to + target[i]);
+            }
+        }
+
+        // Clones other slot by slot, positions and tombstones included.
+        void copy_elements_helper(const soa_hash_map& other) {
+            if(other.SIZE == 0)
+                return;
+            allocate_arrays_helper(other.SIZE);
+            size_type x = 0;
+            try {
+                for(; x < SIZE; x++) {
+                    if(other.states[x] != slot_state::full)
+                        continue;
+                    key_alloc_traits::construct(key_allocator, keys + x, other.keys[x]);
+                    try {
+                        value_alloc_traits::construct(value_allocator, values + x, other.values[x]);
+                    } catch(...) {
+                        key_alloc_traits::destroy(key_allocator, keys + x);
+                        throw;
+                    }
+                    states[x] = slot_state::full;
+                }
+            } catch(...) {
+                destroy_elements_helper();
+                deallocate_arrays_helper(states, keys, values, SIZE);
+                states = nullptr;
+                keys = nullptr;
+                values = nullptr;
+                SIZE = 0;
+                throw;
+            }
+            for(x = 0; x < SIZE; x++)
+                states[x] = other.states[x];
+            NOT_NULL_SIZE = other.NOT_NULL_SIZE;
+            DELETED_SIZE = other.DELETED_SIZE;
+        }
+
+        void steal_elements_helper(soa_hash_map& other) noexcept {
+            SIZE = other.SIZE;
+            NOT_NULL_SIZE = other.NOT_NULL_SIZE;
+            DELETED_SIZE = other.DELETED_SIZE;
+            states = other.states;
+            keys = other.keys;
+            values = other.values;
+            other.SIZE = 0;
+            other.NOT_NULL_SIZE = 0;
+            other.DELETED_SIZE = 0;
+            other.states = nullptr;
+            other.keys = nullptr;
+            other.values = nullptr;
+        }
+
+        iterator make_iterator(size_type x) {
+            return iterator(states, keys, values, x, SIZE);
+        }
+
+        const_iterator make_iterator(size_type x) const {
+            return const_iterator(states, keys, values, x, SIZE);
+        }
+
+        // Grows or compacts the table if it would exceed the load factor
+        // after taking incoming more elements. Returns whether it did.
+        bool check_load_factor(size_type incoming) {
+            if(SIZE == 0)
+                return false;
+            if((float)(NOT_NULL_SIZE + DELETED_SIZE + incoming) / (float)SIZE >= LOAD_FACTOR) {
+                if((float)NOT_NULL_SIZE / (float)SIZE < LOAD_FACTOR / 2)
+                    rehash(SIZE);
+                else
+                    rehash(2 * SIZE + 1);
+                return true;
+            }
+            return false;
+        }
+
+        // Returns the slot of key and true, or the slot an insert of key
+        // should use and false. SIZE stands for no free slot.
+        std::pair<size_type, bool> find_position_helper(const key_type& key) const {
+            if (SIZE == 0)
+                return {SIZE, false};
+            hash_map_key_hash h = hash_key(firstHash, secondHash, key);
+            double_hash_probe::sequence probe(h, SIZE);
+            size_type free_slot = SIZE;
+            for (size_type i = 0; i < SIZE; i++, probe.next()) {
+                size_type x = probe.group();
+                slot_state state = states[x];
+                if (state == slot_state::deleted) {
+                    if (free_slot == SIZE)
+                        free_slot = x;
+                } else if (state == slot_state::empty) {
+                    return {free_slot == SIZE ? x : free_slot, false};
+                } else if (key_equal(keys[x], key)) {
+                    return {x, true};
+                }
+            }
+            return {free_slot, false};
+        }
+
+        // Probes the states of the current table only.
+        size_type find_free_slot_helper(const key_type& key) const {
+            hash_map_key_hash h = hash_key(firstHash, secondHash, key);
+            double_hash_probe::sequence probe(h, SIZE);
+            for (size_type i = 0; i < SIZE; i++, probe.next()) {
+                size_type x = probe.group();
+                if (states[x] != slot_state::full)
+                    return x;
+            }
+            return SIZE;
+        }
+
+        std::pair<size_type, bool> find_insert_position_helper(const key_type& key) {
+            auto pos = find_position_helper(key);
+            while (!pos.second && pos.first == SIZE) {
+                rehash(SIZE == 0 ? INITIAL_SIZE : 2 * SIZE + 1);
+                pos = find_position_helper(key);
+            }
+            return pos;
+        }
+
+        template<typename _Key, typename... _Args>
+        std::pair<iterator, bool> try_emplace_helper(_Key&& k, _Args&&... args) {
+            auto pos = find_insert_position_helper(k);
+            if (pos.second)
+                return {make_iterator(pos.first), false};
+            // Elements move on rehash, so the table makes room before the
+            // new element is constructed.
+            if (check_load_factor(1))
+                pos = find_insert_position_helper(k);
+            size_type x = pos.first;
+            key_alloc_traits::construct(key_allocator, keys + x, std::forward<_Key>(k));
+            try {
+                value_alloc_traits::construct(value_allocator, values + x, std::forward<_Args>(args)...);
+            } catch(...) {
+                key_alloc_traits::destroy(key_allocator, keys + x);
+                throw;
+            }
+            if (states[x] == slot_state::deleted)
+                DELETED_SIZE--;
+            states[x] = slot_state::full;
+            NOT_NULL_SIZE++;
+            return {make_iterator(x), true};
+        }
+
+        friend class hash_map_container_base<soa_hash_map, K, T>;
+
+        void swap_helper(soa_hash_map& x, bool allocators) {
+            std::swap(SIZE, x.SIZE);
+            std::swap(NOT_NULL_SIZE, x.NOT_NULL_SIZE);
+            std::swap(DELETED_SIZE, x.DELETED_SIZE);
+            std::swap(LOAD_FACTOR, x.LOAD_FACTOR);
+            std::swap(states, x.states);
+            std::swap(keys, x.keys);
+            std::swap(values, x.values);
+            std::swap(firstHash, x.firstHash);
+            std::swap(secondHash, x.secondHash);
+            std::swap(key_equal, x.key_equal);
+            if(allocators) {
+                std::swap(state_allocator, x.state_allocator);
+                std::swap(key_allocator, x.key_allocator);
+                std::swap(value_allocator, x.value_allocator);
+            }
+        }
+
+    public:
+        /// Default constructor. The first insert allocates the table.
+        soa_hash_map() {}
+
+        /**
+         *  @brief  Default constructor creates no elements.
+         *  @param n  Minimal initial number of buckets.
+         */
+        explicit soa_hash_map(size_type n) {
+            if(n > 0)
+                allocate_arrays_helper(n);
+        }
+
+        explicit soa_hash_map(const allocator_type& a)
+        : state_allocator(a), key_allocator(a), value_allocator(a) {}
+
+        /// Copy constructor.
+        soa_hash_map(const soa_hash_map& other)
+        : soa_hash_map(other, alloc_traits::select_on_container_copy_construction(other.get_allocator())) {}
+
+        /// Copy constructor with allocator argument.
+        soa_hash_map(const soa_hash_map& other, const allocator_type& a)
+        : LOAD_FACTOR(other.LOAD_FACTOR), firstHash(other.firstHash), secondHash(other.secondHash),
+          key_equal(other.key_equal), state_allocator(a), key_allocator(a), value_allocator(a) {
+            copy_elements_helper(other);
+        }
+
+        /// Move constructor.
+        soa_hash_map(soa_hash_map&& other)
+        : LOAD_FACTOR(other.LOAD_FACTOR), firstHash(std::move(other.firstHash)),
+          secondHash(std::move(other.secondHash)), key_equal(std::move(other.key_equal)),
+          state_allocator(std::move(other.state_allocator)),
+          key_allocator(std::move(other.key_allocator)), value_allocator(std::move(other.value_allocator)) {
+            steal_elements_helper(other);
+        }
+
+        /**
+         *  @brief  Move constructor with allocator argument.
+         *
+         *  The memory of @a other is adopted only if its allocator compares
+         *  equal to @a a; otherwise its elements are moved one by one.
+         */
+        soa_hash_map(soa_hash_map&& other, const allocator_type& a)
+        : LOAD_FACTOR(other.LOAD_FACTOR), firstHash(other.firstHash), secondHash(other.secondHash),
+          key_equal(other.key_equal), state_allocator(a), key_allocator(a), value_allocator(a) {
+            this->move_construct_helper(other);
+        }
+
+        /// Builds an %soa_hash_map from an initializer_list.
+        soa_hash_map(std::initializer_list<value_type> l, size_type n = 0)
+        : soa_hash_map(n) {
+            this->insert(l);
+        }
+
+        ~soa_hash_map() {
+            if(states == nullptr)
+                return;
+            destroy_elements_helper();
+            deallocate_arrays_helper(states, keys, values, SIZE);
+        }
+
+        /// Copy assignment operator.
+        soa_hash_map& operator=(const soa_hash_map& other) {
+            return this->copy_assign_helper(other);
+        }
+
+        /// Move assignment operator.
+        soa_hash_map& operator=(soa_hash_map&& other) {
+            return this->move_assign_helper(std::move(other));
+        }
+
+        ///  Returns the allocator object used by the %soa_hash_map.
+        allocator_type get_allocator() const noexcept {
+            return allocator_type(state_allocator);
+        }
+
+        ///  Returns the size of the %soa_hash_map.
+        size_type size() const noexcept {
+            return NOT_NULL_SIZE;
+        }
+
+        ///  Returns the number of slots of the %soa_hash_map.
+        size_type max_size() const noexcept {
+            return SIZE;
+        }
+
+        iterator begin() noexcept {
+            iterator it = make_iterator(0);
+            it.seek_helper();
+            return it;
+        }
+
+        const_iterator begin() const noexcept {
+            const_iterator it = make_iterator(0);
+            it.seek_helper();
+            return it;
+        }
+
+        iterator end() noexcept {
+            return make_iterator(SIZE);
+        }
+
+        const_iterator end() const noexcept {
+            return make_iterator(SIZE);
+        }
+
+        /**
+         *  @brief Erases elements according to the provided key.
+         *  @param  key  Key of element to be erased.
+         *  @return  The number of elements erased.
+         */
+        size_type erase(const key_type& key) {
+            auto pos = find_position_helper(key);
+            if (!pos.second)
+                return 0;
+            destroy_slot_helper(pos.first);
+            states[pos.first] = slot_state::deleted;
+            NOT_NULL_SIZE--;
+            DELETED_SIZE++;
+            return 1;
+        }
+
+        /**
+         *  @brief Erases an element from an %soa_hash_map.
+         *  @param  position  An iterator pointing to the element to be erased.
+         *  @return An iterator pointing to the next element.
+         */
+        iterator erase(const_iterator position) {
+            size_type x = position.cur_index;
+            destroy_slot_helper(x);
+            states[x] = slot_state::deleted;
+            NOT_NULL_SIZE--;
+            DELETED_SIZE++;
+            iterator next = make_iterator(x);
+            ++next;
+            return next;
+        }
+
+        /// Erases all elements and releases the table.
+        void clear() noexcept {
+            if(states == nullptr)
+                return;
+            destroy_elements_helper();
+            deallocate_arrays_helper(states, keys, values, SIZE);
+            states = nullptr;
+            keys = nullptr;
+            values = nullptr;
+            SIZE = 0;
+            NOT_NULL_SIZE = 0;
+            DELETED_SIZE = 0;
+        }
+
+        //@{
+        /**
+         *  @brief Tries to locate an element in an %soa_hash_map.
+         *  @param  key  Key to be located.
+         *  @return  Iterator pointing to sought-after element, or end() if not
+         *           found.
+         */
+        iterator find(const key_type& key) {
+            auto pos = find_position_helper(key);
+            return make_iterator(pos.second ? pos.first : SIZE);
+        }
+
+        const_iterator find(const key_type& key) const {
+            auto pos = find_position_helper(key);
+            return make_iterator(pos.second ? pos.first : SIZE);
+        }
+        //@}
+
+        //@{
+        /**
+         *  @brief  Calls @a f with every mapped value.
+         *
+         *  Walks the state and value arrays front to back without touching
+         *  the keys, which suits reductions over the values.
+         */
+        template<typename F>
+        void for_each_value(F f) {
+            for(size_type x = 0; x < SIZE; x++) {
+                if(states[x] == slot_state::full)
+                    f(values[x]);
+            }
+        }
+
+        template<typename F>
+        void for_each_value(F f) const {
+            for(size_type x = 0; x < SIZE; x++) {
+                if(states[x] == slot_state::full)
+                    f(static_cast<const mapped_type&>(values[x]));
+            }
+        }
+        //@}
+
+        /// Returns the average number of elements per slot.
+        float load_factor() const noexcept {
+            return SIZE == 0 ? 0 : (float)NOT_NULL_SIZE / (float)SIZE;
+        }
+
+        /// Returns the load factor the %soa_hash_map keeps below.
+        float max_load_factor() const noexcept {
+            return LOAD_FACTOR;
+        }
+
+        /// Changes the maximum load factor. z must lie in (0, 1).
+        void max_load_factor(float z) {
+            LOAD_FACTOR = z;
+            check_load_factor(0);
+        }
+
+        /**
+         *  @brief  Rebuilds the table with at least @a n slots.
+         *
+         *  Positions are worked out on the new state array first, so a probe
+         *  sequence running out of free slots retries with a bigger table
+         *  before any element has moved.
+         */
+        void rehash(size_type n) {
+            if(n <= NOT_NULL_SIZE)
+                n = NOT_NULL_SIZE + 1;
+            size_type PAST_SIZE = SIZE;
+            slot_state* past_states = states;
+            key_type* past_keys = keys;
+            mapped_type* past_values = values;
+            // Slot of each old element in the new table, found before any
+            // element moves.
+            index_allocator_type index_allocator(state_allocator);
+            size_type* target = index_alloc_traits::allocate(index_allocator, PAST_SIZE);
+
+            for(;;) {
+                try {
+                    allocate_arrays_helper(n);
+                } catch(...) {
+                    index_alloc_traits::deallocate(index_allocator, target, PAST_SIZE);
+                    SIZE = PAST_SIZE;
+                    states = past_states;
+                    keys = past_keys;
+                    values = past_values;
+                    throw;
+                }
+                bool placed = true;
+                for(size_type i = 0; placed && i < PAST_SIZE; i++) {
+                    if(past_states[i] != slot_state::full)
+                        continue;
+                    size_type x = find_free_slot_helper(past_keys[i]);
+                    if(x == SIZE) {
+                        placed = false;
+                    } else {
+                        states[x] = slot_state::full;
+                        target[i] = x;
+                    }
+                }
+                if(placed)
+                    break;
+                deallocate_arrays_helper(states, keys, values, SIZE);
+                n = 2 * n + 1;
+            }
+
+            // The array whose moves may throw goes first, so a failure in
+            // either pass leaves the old elements as they were.
+            try {
+                if(std::is_nothrow_move_constructible<mapped_type>::value) {
+                    transfer_array_helper(key_allocator, keys, past_keys, past_states, target, PAST_SIZE);
+                    try {
+                        transfer_array_helper(value_allocator, values, past_values, past_states, target, PAST_SIZE);
+                    } catch(...) {
+                        destroy_array_helper(key_allocator, keys, past_states, target, PAST_SIZE);
+                        throw;
+                    }
+                } else {
+                    transfer_array_helper(value_allocator, values, past_values, past_states, target, PAST_SIZE);
+                    try {
+                        transfer_array_helper(key_allocator, keys, past_keys, past_states, target, PAST_SIZE);
+                    } catch(...) {
+                        destroy_array_helper(value_allocator, values, past_states, target, PAST_SIZE);
+                        throw;
+                    }
+                }
+            } catch(...) {
+                deallocate_arrays_helper(states, keys, values, SIZE);
+                index_alloc_traits::deallocate(index_allocator, target, PAST_SIZE);
+                SIZE = PAST_SIZE;
+                states = past_states;
+                keys = past_keys;
+                values = past_values;
+                throw;
+            }
+            for(size_type i = 0; i < PAST_SIZE; i++) {
+                if(past_states[i] != slot_state::full)
+                    continue;
+                value_alloc_traits::destroy(value_allocator, past_values + i);
+                key_alloc_traits::destroy(key_allocator, past_keys + i);
+            }
+            index_alloc_traits::deallocate(index_allocator, target, PAST_SIZE);
+            DELETED_SIZE = 0;
+            deallocate_arrays_helper(past_states, past_keys, past_values, PAST_SIZE);
+        }
+
+        /// Prepares the %soa_hash_map for @a n elements.
+        void reserve(size_type n) {
+            rehash(ceil((float)n / (float)max_load_factor()));
+        }
+    };
+
+} // namespace fefu
+
+
+
+#endif //HASHMAP_SOA_HASH_MAP_H
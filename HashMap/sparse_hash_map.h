@@ -0,0 +1,722 @@
+#ifndef HASHMAP_SPARSE_HASH_MAP_H
+#define HASHMAP_SPARSE_HASH_MAP_H
+
+
+#pragma once
+
+#include "hash_map.h"
+
+#include <iterator>
+#include <stdexcept>
+
+namespace fefu
+{
+
+    /**
+     *  48 slots of a %sparse_hash_map. Only occupied slots take space: their
+     *  elements are stored in slot order in items, and a slot finds its
+     *  element by counting the occupied bits below it. Erased slots are
+     *  remembered in deleted so that probe sequences run through them.
+     */
+    template<typename Value>
+    struct sparse_hash_map_group {
+        static constexpr std::size_t width = 48;
+
+        Value* items;
+        std::uint64_t occupied;
+        std::uint64_t deleted;
+
+        static std::uint64_t bit(std::size_t slot) noexcept {
+            return std::uint64_t(1) << slot;
+        }
+
+        std::size_t count() const noexcept {
+            return popcount(occupied);
+        }
+
+        // Position in items of the element of an occupied slot, or of the
+        // element a free slot would receive.
+        std::size_t offset(std::size_t slot) const noexcept {
+            return popcount(occupied & (bit(slot) - 1));
+        }
+
+        static std::size_t popcount(std::uint64_t mask) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<std::size_t>(__builtin_popcountll(mask));
+#else
+            std::size_t n = 0;
+            for(; mask; mask &= mask - 1)
+                n++;
+            return n;
+#endif
+        }
+    };
+
+    template<typename Value>
+    constexpr std::size_t sparse_hash_map_group<Value>::width;
+
+
+    /**
+     *  Iterator of a %sparse_hash_map. Walks the item arrays group by group
+     *  and hands out element pointers, like the %hash_map iterators.
+     */
+    template<typename ValueType>
+    class sparse_hash_map_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ValueType;
+        using difference_type = std::ptrdiff_t;
+        using reference = ValueType*;
+        using pointer = ValueType*;
+        using group_type = sparse_hash_map_group<typename std::remove_const<ValueType>::type>;
+
+        sparse_hash_map_iterator() noexcept {}
+
+        sparse_hash_map_iterator(const group_type* groups, size_t group, size_t item, size_t group_count) noexcept
+        : groups(groups), group(group), item(item), group_count(group_count) {}
+
+        template<typename U, typename = typename std::enable_if<std::is_same<const U, ValueType>::value>::type>
+        sparse_hash_map_iterator(const sparse_hash_map_iterator<U>& other) noexcept
+        : groups(other.groups), group(other.group), item(other.item), group_count(other.group_count) {}
+
+        reference operator*() const {
+            return groups[group].items + item;
+        }
+        pointer operator->() const {
+            return **this;
+        }
+
+        // prefix ++
+        sparse_hash_map_iterator& operator++() {
+            item++;
+            seek_helper();
+            return *this;
+        }
+        // postfix ++
+        sparse_hash_map_iterator operator++(int) {
+            sparse_hash_map_iterator old = *this;
+            ++(*this);
+            return old;
+        }
+
+        friend bool operator==(const sparse_hash_map_iterator& l_point, const sparse_hash_map_iterator& r_point) {
+            return l_point.groups == r_point.groups && l_point.group == r_point.group && l_point.item == r_point.item;
+        }
+        friend bool operator!=(const sparse_hash_map_iterator& l_point, const sparse_hash_map_iterator& r_point) {
+            return !(l_point == r_point);
+        }
+
+    private:
+        template<typename>
+        friend class sparse_hash_map_iterator;
+        template<typename, typename, class, class, typename, typename>
+        friend class sparse_hash_map;
+
+        // Moves past exhausted groups; the end is (group_count, 0).
+        void seek_helper() noexcept {
+            while (group < group_count && item == groups[group].count()) {
+                group++;
+                item = 0;
+            }
+        }
+
+        const group_type* groups;
+        size_t group;
+        size_t item;
+        size_t group_count;
+    };
+
+
+    /**
+     *  Memory-lean open addressing map in the style of sparsehash. The
+     *  table is cut into groups of 48 slots, each with an occupied and a
+     *  deleted bitmap and an exactly sized array of the elements of its
+     *  occupied slots. An empty slot costs 4 bits and there are no
+     *  per-element nodes, allocator headers or cached hashes.
+     *
+     *  Every insert and erase reallocates the item array of one group, and
+     *  elements move when that happens, so references into the map are
+     *  invalidated by insert, erase and rehash.
+     */
+    template<typename K, typename T,
+            class FirstHash = FirstKeyHash<K>,
+            class SecondHash = SecondKeyHash<K>,
+            typename Pred = std::equal_to<K>,
+            typename Alloc = allocator<std::pair<const K, T>*>>
+    class sparse_hash_map : public hash_map_container_base<sparse_hash_map<K, T, FirstHash, SecondHash, Pred, Alloc>, K, T>
+    {
+    public:
+        using key_type = K;
+        using mapped_type = T;
+        using allocator_type = Alloc;
+        using value_type = std::pair<const key_type, mapped_type>;
+        using iterator = sparse_hash_map_iterator<value_type>;
+        using const_iterator = sparse_hash_map_iterator<const value_type>;
+        using size_type = std::size_t;
+
+    private:
+        using group_type = typename iterator::group_type;
+        using alloc_traits = std::allocator_traits<allocator_type>;
+        using item_allocator_type = typename alloc_traits::template rebind_alloc<value_type>;
+        using group_allocator_type = typename alloc_traits::template rebind_alloc<group_type>;
+        using item_alloc_traits = std::allocator_traits<item_allocator_type>;
+        using group_alloc_traits = std::allocator_traits<group_allocator_type>;
+
+        size_type SIZE = 0;
+        size_type NOT_NULL_SIZE = 0;
+        size_type DELETED_SIZE = 0;
+        float LOAD_FACTOR = 0.7;
+        group_type* groups = nullptr;
+        FirstHash firstHash;
+        SecondHash secondHash;
+        Pred key_equal;
+        group_allocator_type group_allocator{allocator_type()};
+        item_allocator_type item_allocator{group_allocator};
+
+        size_type group_count_helper() const noexcept {
+            return SIZE / group_type::width;
+        }
+
+        // The slot count is rounded up to whole groups.
+        void allocate_groups_helper(size_type n) {
+            size_type count = (n + group_type::width - 1) / group_type::width;
+            if(count == 0)
+                count = 1;
+            groups = group_alloc_traits::allocate(group_allocator, count);
+            SIZE = count * group_type::width;
+            for(size_type g = 0; g < count; g++)
+                groups[g] = group_type{nullptr, 0, 0};
+        }
+
+        void deallocate_items_helper(value_type* items, size_type n) {
+            if(items != nullptr)
+                item_alloc_traits::deallocate(item_allocator, items, n);
+        }
+
+        void destroy_items_helper(value_type* items, size_type n) {
+            for(size_type i = 0; i < n; i++)
+                item_alloc_traits::destroy(item_allocator, items + i);
+        }
+
+        // Frees every element and the group array.
+        void release_helper() noexcept {
+            for(size_type g = 0; g < group_count_helper(); g++) {
+                size_type n = groups[g].count();
+                destroy_items_helper(groups[g].items, n);
+                deallocate_items_helper(groups[g].items, n);
+            }
+            if(groups != nullptr)
+                group_alloc_traits::deallocate(group_allocator, groups, group_count_helper());
+            groups = nullptr;
+            SIZE = 0;
+            NOT_NULL_SIZE = 0;
+            DELETED_SIZE = 0;
+        }
+
+        // Fills items with the n elements of group, leaving out position
+        // skip when shrinking or leaving position skip of items to the
+        // caller when growing. Elements are moved when that cannot throw
+        // and copied otherwise, so the old array is intact if this throws;
+        // the elements it constructed are destroyed then.
+        void transfer_items_helper(const group_type& group, size_type n, value_type* items,
+                                   size_type skip, bool grow) {
+            auto destination = [&](size_type i) {
+                return i < skip ? i : (grow ? i + 1 : i - 1);
+            };
+            size_type i = 0;
+            try {
+                for(; i < n; i++) {
+                    if(!grow && i == skip)
+                        continue;
+                    item_alloc_traits::construct(item_allocator, items + destination(i),
+                                                 std::move_if_noexcept(group.items[i]));
+                }
+            } catch(...) {
+                for(size_type j = 0; j < i; j++) {
+                    if(grow || j != skip)
+                        item_alloc_traits::destroy(item_allocator, items + destination(j));
+                }
+                throw;
+            }
+        }
+
+        // Builds the item array group has once position skip loses its
+        // element.
+        value_type* shrink_items_helper(const group_type& group, size_type n, size_type skip) {
+            if(n == 1)
+                return nullptr;
+            value_type* items = item_alloc_traits::allocate(item_allocator, n - 1);
+            try {
+                transfer_items_helper(group, n, items, skip, false);
+            } catch(...) {
+                item_alloc_traits::deallocate(item_allocator, items, n - 1);
+                throw;
+            }
+            return items;
+        }
+
+        void replace_items_helper(group_type& group, value_type* items, size_type n) {
+            destroy_items_helper(group.items, n);
+            deallocate_items_helper(group.items, n);
+            group.items = items;
+        }
+
+        // Clones other group by group, bitmaps included.
+        void copy_elements_helper(const sparse_hash_map& other) {
+            if(other.SIZE == 0)
+                return;
+            allocate_groups_helper(other.SIZE);
+            try {
+                for(size_type g = 0; g < group_count_helper(); g++) {
+                    size_type n = other.groups[g].count();
+                    if(n == 0)
+                        continue;
+                    value_type* items = item_alloc_traits::allocate(item_allocator, n);
+                    size_type i = 0;
+                    try {
+                        for(; i < n; i++)
+                            item_alloc_traits::construct(item_allocator, items + i, other.groups[g].items[i]);
+                    } catch(...) {
+                        destroy_items_helper(items, i);
+                        item_alloc_traits::deallocate(item_allocator, items, n);
+                        throw;
+                    }
+                    groups[g].items = items;
+                    groups[g].occupied = other.groups[g].occupied;
+                }
+            } catch(...) {
+                release_helper();
+                throw;
+            }
+            for(size_type g = 0; g < group_count_helper(); g++)
+                groups[g].deleted = other.groups[g].deleted;
+            NOT_NULL_SIZE = other.NOT_NULL_SIZE;
+            DELETED_SIZE = other.DELETED_SIZE;
+        }
+
+        iterator make_iterator(size_type g, size_type item) {
+            return iterator(groups, g, item, group_count_helper());
+        }
+
+        const_iterator make_iterator(size_type g, size_type item) const {
+            return const_iterator(groups, g, item, group_count_helper());
+        }
+
+        iterator slot_iterator_helper(size_type x) {
+            const group_type& group = groups[x / group_type::width];
+            return make_iterator(x / group_type::width, group.offset(x % group_type::width));
+        }
+
+        const_iterator slot_iterator_helper(size_type x) const {
+            const group_type& group = groups[x / group_type::width];
+            return make_iterator(x / group_type::width, group.offset(x % group_type::width));
+        }
+
+        value_type& item_helper(size_type x) const noexcept {
+            const group_type& group = groups[x / group_type::width];
+            return group.items[group.offset(x % group_type::width)];
+        }
+
+        void check_load_factor() {
+            if(SIZE == 0)
+                return;
+            if((float)(NOT_NULL_SIZE + DELETED_SIZE) / (float)SIZE >= LOAD_FACTOR) {
+                if((float)NOT_NULL_SIZE / (float)SIZE < LOAD_FACTOR / 2)
+                    rehash(SIZE);
+                else
+                    rehash(2 * SIZE);
+            }
+        }
+
+        // Returns the slot of key and true, or the slot an insert of key
+        // should use and false. SIZE stands for no free slot.
+        std::pair<size_type, bool> find_position_helper(const key_type& key) const {
+            if (SIZE == 0)
+                return {SIZE, false};
+            hash_map_key_hash h = hash_key(firstHash, secondHash, key);
+            double_hash_probe::sequence probe(h, SIZE);
+            size_type free_slot = SIZE;
+            for (size_type i = 0; i < SIZE; i++, probe.next()) {
+                size_type x = probe.group();
+                const group_type& group = groups[x / group_type::width];
+                std::uint64_t bit = group_type::bit(x % group_type::width);
+                if (group.occupied & bit) {
+                    if (key_equal(group.items[group.offset(x % group_type::width)].first, key))
+                        return {x, true};
+                } else if (group.deleted & bit) {
+                    if (free_slot == SIZE)
+                        free_slot = x;
+                } else {
+                    return {free_slot == SIZE ? x : free_slot, false};
+                }
+            }
+            return {free_slot, false};
+        }
+
+        // Returns the first slot of the probe sequence of key whose bit is
+        // clear in the given bitmap, the occupied one unless rehash says
+        // otherwise.
+        size_type find_free_slot_helper(const key_type& key,
+                                        std::uint64_t group_type::* bitmap = &group_type::occupied) const {
+            hash_map_key_hash h = hash_key(firstHash, secondHash, key);
+            double_hash_probe::sequence probe(h, SIZE);
+            for (size_type i = 0; i < SIZE; i++, probe.next()) {
+                size_type x = probe.group();
+                if (!(groups[x / group_type::width].*bitmap & group_type::bit(x % group_type::width)))
+                    return x;
+            }
+            return SIZE;
+        }
+
+        std::pair<size_type, bool> find_insert_position_helper(const key_type& key) {
+            auto pos = find_position_helper(key);
+            while (!pos.second && pos.first == SIZE) {
+                rehash(SIZE == 0 ? group_type::width : 2 * SIZE);
+                pos = find_position_helper(key);
+            }
+            return pos;
+        }
+
+        template<typename... _Args>
+        std::pair<iterator, bool> try_emplace_helper(const key_type& k, _Args&&... args) {
+            check_load_factor();
+            auto pos = find_insert_position_helper(k);
+            if (pos.second)
+                return {slot_iterator_helper(pos.first), false};
+            group_type& group = groups[pos.first / group_type::width];
+            size_type slot = pos.first % group_type::width;
+            size_type n = group.count();
+            size_type at = group.offset(slot);
+            // The new element is built before any element of the group
+            // moves, so a throwing constructor leaves the group untouched.
+            value_type* items = item_alloc_traits::allocate(item_allocator, n + 1);
+            try {
+                item_alloc_traits::construct(item_allocator, items + at, std::piecewise_construct,
+                                             std::forward_as_tuple(k),
+                                             std::forward_as_tuple(std::forward<_Args>(args)...));
+            } catch(...) {
+                item_alloc_traits::deallocate(item_allocator, items, n + 1);
+                throw;
+            }
+            try {
+                transfer_items_helper(group, n, items, at, true);
+            } catch(...) {
+                item_alloc_traits::destroy(item_allocator, items + at);
+                item_alloc_traits::deallocate(item_allocator, items, n + 1);
+                throw;
+            }
+            replace_items_helper(group, items, n);
+            if (group.deleted & group_type::bit(slot)) {
+                group.deleted &= ~group_type::bit(slot);
+                DELETED_SIZE--;
+            }
+            group.occupied |= group_type::bit(slot);
+            NOT_NULL_SIZE++;
+            return {make_iterator(pos.first / group_type::width, at), true};
+        }
+
+        void erase_slot_helper(size_type x) {
+            group_type& group = groups[x / group_type::width];
+            size_type slot = x % group_type::width;
+            size_type n = group.count();
+            value_type* items = shrink_items_helper(group, n, group.offset(slot));
+            replace_items_helper(group, items, n);
+            group.occupied &= ~group_type::bit(slot);
+            group.deleted |= group_type::bit(slot);
+            NOT_NULL_SIZE--;
+            DELETED_SIZE++;
+        }
+
+        friend class hash_map_container_base<sparse_hash_map, K, T>;
+
+        void swap_helper(sparse_hash_map& x, bool allocators) {
+            std::swap(SIZE, x.SIZE);
+            std::swap(NOT_NULL_SIZE, x.NOT_NULL_SIZE);
+            std::swap(DELETED_SIZE, x.DELETED_SIZE);
+            std::swap(LOAD_FACTOR, x.LOAD_FACTOR);
+            std::swap(groups, x.groups);
+            std::swap(firstHash, x.firstHash);
+            std::swap(secondHash, x.secondHash);
+            std::swap(key_equal, x.key_equal);
+            if(allocators) {
+                std::swap(group_allocator, x.group_allocator);
+                std::swap(item_allocator, x.item_allocator);
+            }
+        }
+
+    public:
+        /// Default constructor. The first insert allocates the table.
+        sparse_hash_map() {}
+
+        /**
+         *  @brief  Default constructor creates no elements.
+         *  @param n  Minimal initial number of buckets.
+         */
+        explicit sparse_hash_map(size_type n) {
+            if(n > 0)
+                allocate_groups_helper(n);
+        }
+
+        explicit sparse_hash_map(const allocator_type& a)
+        : group_allocator(a), item_allocator(a) {}
+
+        /// Copy constructor.
+        sparse_hash_map(const sparse_hash_map& other)
+        : sparse_hash_map(other, alloc_traits::select_on_container_copy_construction(other.get_allocator())) {}
+
+        /// Copy constructor with allocator argument.
+        sparse_hash_map(const sparse_hash_map& other, const allocator_type& a)
+        : LOAD_FACTOR(other.LOAD_FACTOR), firstHash(other.firstHash), secondHash(other.secondHash),
+          key_equal(other.key_equal), group_allocator(a), item_allocator(a) {
+            copy_elements_helper(other);
+        }
+
+        /// Move constructor.
+        sparse_hash_map(sparse_hash_map&& other)
+        : SIZE(other.SIZE), NOT_NULL_SIZE(other.NOT_NULL_SIZE), DELETED_SIZE(other.DELETED_SIZE),
+          LOAD_FACTOR(other.LOAD_FACTOR), groups(other.groups),
+          firstHash(std::move(other.firstHash)), secondHash(std::move(other.secondHash)),
+          key_equal(std::move(other.key_equal)), group_allocator(std::move(other.group_allocator)),
+          item_allocator(std::move(other.item_allocator)) {
+            other.groups = nullptr;
+            other.SIZE = 0;
+            other.NOT_NULL_SIZE = 0;
+            other.DELETED_SIZE = 0;
+        }
+
+        /**
+         *  @brief  Move constructor with allocator argument.
+         *
+         *  The memory of @a other is adopted only if its allocator compares
+         *  equal to @a a; otherwise its elements are moved one by one.
+         */
+        sparse_hash_map(sparse_hash_map&& other, const allocator_type& a)
+        : LOAD_FACTOR(other.LOAD_FACTOR), firstHash(other.firstHash), secondHash(other.secondHash),
+          key_equal(other.key_equal), group_allocator(a), item_allocator(a) {
+            this->move_construct_helper(other);
+        }
+
+        /// Builds a %sparse_hash_map from an initializer_list.
+        sparse_hash_map(std::initializer_list<value_type> l) {
+            this->insert(l);
+        }
+
+        ~sparse_hash_map() {
+            release_helper();
+        }
+
+        /// Copy assignment operator.
+        sparse_hash_map& operator=(const sparse_hash_map& other) {
+            return this->copy_assign_helper(other);
+        }
+
+        /// Move assignment operator.
+        sparse_hash_map& operator=(sparse_hash_map&& other) {
+            return this->move_assign_helper(std::move(other));
+        }
+
+        ///  Returns the allocator object used by the %sparse_hash_map.
+        allocator_type get_allocator() const noexcept {
+            return allocator_type(group_allocator);
+        }
+
+        ///  Returns the size of the %sparse_hash_map.
+        size_type size() const noexcept {
+            return NOT_NULL_SIZE;
+        }
+
+        ///  Returns the number of slots of the %sparse_hash_map.
+        size_type max_size() const noexcept {
+            return SIZE;
+        }
+
+        iterator begin() noexcept {
+            iterator it = make_iterator(0, 0);
+            it.seek_helper();
+            return it;
+        }
+
+        const_iterator begin() const noexcept {
+            const_iterator it = make_iterator(0, 0);
+            it.seek_helper();
+            return it;
+        }
+
+        iterator end() noexcept {
+            return make_iterator(group_count_helper(), 0);
+        }
+
+        const_iterator end() const noexcept {
+            return make_iterator(group_count_helper(), 0);
+        }
+
+        /**
+         *  @brief Erases elements according to the provided key.
+         *  @param  key  Key of element to be erased.
+         *  @return  The number of elements erased.
+         */
+        size_type erase(const key_type& key) {
+            auto pos = find_position_helper(key);
+            if (!pos.second)
+                return 0;
+            erase_slot_helper(pos.first);
+            return 1;
+        }
+
+        /// Erases all elements and releases the table.
+        void clear() noexcept {
+            release_helper();
+        }
+
+        //@{
+        /**
+         *  @brief Tries to locate an element in a %sparse_hash_map.
+         *  @param  key  Key to be located.
+         *  @return  Iterator pointing to sought-after element, or end() if not
+         *           found.
+         */
+        iterator find(const key_type& key) {
+            auto pos = find_position_helper(key);
+            return pos.second ? slot_iterator_helper(pos.first) : end();
+        }
+
+        const_iterator find(const key_type& key) const {
+            auto pos = find_position_helper(key);
+            return pos.second ? slot_iterator_helper(pos.first) : end();
+        }
+        //@}
+
+        /// Returns the average number of elements per slot.
+        float load_factor() const noexcept {
+            return SIZE == 0 ? 0 : (float)NOT_NULL_SIZE / (float)SIZE;
+        }
+
+        /// Returns the load factor the %sparse_hash_map keeps below.
+        float max_load_factor() const noexcept {
+            return LOAD_FACTOR;
+        }
+
+        /// Changes the maximum load factor. z must lie in (0, 1).
+        void max_load_factor(float z) {
+            LOAD_FACTOR = z;
+            check_load_factor();
+        }
+
+        /**
+         *  @brief  Returns the bytes held by the %sparse_hash_map.
+         *
+         *  The item array pointers count as table, the bitmaps as metadata
+         *  and the elements as nodes. Item arrays are sized exactly, so
+         *  slack is the bitmap space of slots without an element.
+         */
+        hash_map_memory_usage memory_usage() const noexcept {
+            hash_map_memory_usage usage;
+            usage.table = group_count_helper() * sizeof(value_type*);
+            usage.metadata = group_count_helper() * sizeof(group_type) - usage.table;
+            usage.nodes = NOT_NULL_SIZE * sizeof(value_type);
+            usage.slack = SIZE == 0 ? 0 : (SIZE - NOT_NULL_SIZE) * sizeof(group_type) / group_type::width;
+            usage.tombstones = SIZE == 0 ? 0 : DELETED_SIZE * sizeof(group_type) / group_type::width;
+            usage.backing = table_backing::allocator;
+            return usage;
+        }
+
+        /**
+         *  @brief  Rebuilds the table with at least @a n slots.
+         *
+         *  The new bitmaps are filled first, then every group gets its item
+         *  array in one allocation. The old table stays intact until all
+         *  elements are in place. Elements are then placed by replaying the
+         *  same probes, with the unused deleted bitmaps marking the slots
+         *  already filled, so no side buffer of targets is needed.
+         */
+        void rehash(size_type n) {
+            if(n <= NOT_NULL_SIZE)
+                n = NOT_NULL_SIZE + 1;
+            size_type PAST_SIZE = SIZE;
+            group_type* past_groups = groups;
+            size_type past_count = group_count_helper();
+            size_type past_elements = NOT_NULL_SIZE;
+            size_type past_deleted = DELETED_SIZE;
+
+            auto restore = [&]() {
+                groups = past_groups;
+                SIZE = PAST_SIZE;
+                NOT_NULL_SIZE = past_elements;
+                DELETED_SIZE = past_deleted;
+            };
+
+            for(;;) {
+                try {
+                    allocate_groups_helper(n);
+                } catch(...) {
+                    restore();
+                    throw;
+                }
+                bool placed = true;
+                for(size_type g = 0; placed && g < past_count; g++) {
+                    for(size_type i = 0; placed && i < past_groups[g].count(); i++) {
+                        size_type x = find_free_slot_helper(past_groups[g].items[i].first);
+                        if(x == SIZE) {
+                            placed = false;
+                        } else {
+                            groups[x / group_type::width].occupied |= group_type::bit(x % group_type::width);
+                        }
+                    }
+                }
+                if(placed)
+                    break;
+                group_alloc_traits::deallocate(group_allocator, groups, group_count_helper());
+                n = 2 * n;
+            }
+
+            try {
+                for(size_type g = 0; g < group_count_helper(); g++) {
+                    size_type count = groups[g].count();
+                    if(count != 0)
+                        groups[g].items = item_alloc_traits::allocate(item_allocator, count);
+                }
+                for(size_type g = 0; g < past_count; g++) {
+                    for(size_type i = 0; i < past_groups[g].count(); i++) {
+                        size_type x = find_free_slot_helper(past_groups[g].items[i].first, &group_type::deleted);
+                        item_alloc_traits::construct(item_allocator, &item_helper(x),
+                                                     std::move_if_noexcept(past_groups[g].items[i]));
+                        groups[x / group_type::width].deleted |= group_type::bit(x % group_type::width);
+                    }
+                }
+            } catch(...) {
+                for(size_type g = 0; g < group_count_helper(); g++) {
+                    for(size_type slot = 0; slot < group_type::width; slot++) {
+                        if(groups[g].deleted & group_type::bit(slot))
+                            item_alloc_traits::destroy(item_allocator, groups[g].items + groups[g].offset(slot));
+                    }
+                    deallocate_items_helper(groups[g].items, groups[g].count());
+                }
+                group_alloc_traits::deallocate(group_allocator, groups, group_count_helper());
+                restore();
+                throw;
+            }
+
+            for(size_type g = 0; g < group_count_helper(); g++)
+                groups[g].deleted = 0;
+            NOT_NULL_SIZE = past_elements;
+            DELETED_SIZE = 0;
+            for(size_type g = 0; g < past_count; g++) {
+                size_type count = past_groups[g].count();
+                destroy_items_helper(past_groups[g].items, count);
+                deallocate_items_helper(past_groups[g].items, count);
+            }
+            if(past_groups != nullptr)
+                group_alloc_traits::deallocate(group_allocator, past_groups, past_count);
+        }
+
+        /// Prepares the %sparse_hash_map for @a n elements.
+        void reserve(size_type n) {
+            rehash(ceil((float)n / (float)max_load_factor()));
+        }
+    };
+
+} // namespace fefu
+
+
+
+#endif //HASHMAP_SPARSE_HASH_MAP_H
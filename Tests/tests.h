@@ -8,6 +8,14 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include "../HashMap/hash_map.h"
+#include "../HashMap/soa_hash_map.h"
+#include "../HashMap/integer_hash_map.h"
+#include "../HashMap/compact_hash_map.h"
+#include "../HashMap/sparse_hash_map.h"
+#include "../HashMap/direct_hash_map.h"
+#include "../HashMap/ordered_hash_map.h"
+#include "../HashMap/extendible_hash_map.h"
+#include "../HashMap/linear_hash_map.h"
 
 
 TEST (HashMapTesting, MoveConstructorTest) {
@@ -133,6 +141,25 @@ TEST (HashMapTesting, InsertOrAssignElements) {
 
 }
 
+TEST (HashMapTesting, UpsertAndModifyTest) {
+    fefu::hash_map<int, int> counters;
+    auto add = [](int& count, int increment) { count += increment; };
+
+    ASSERT_TRUE(counters.upsert(7, 1, add));
+    ASSERT_FALSE(counters.upsert(7, 1, add));
+    ASSERT_FALSE(counters.upsert(7, 5, add));
+    ASSERT_TRUE(counters.upsert(8, 2, add));
+
+    ASSERT_TRUE(counters.at(7) == 7);
+    ASSERT_TRUE(counters.at(8) == 2);
+    ASSERT_TRUE(counters.size() == 2);
+
+    ASSERT_TRUE(counters.modify(8, [](int& count) { count *= 10; }));
+    ASSERT_TRUE(counters.at(8) == 20);
+    ASSERT_FALSE(counters.modify(9, [](int& count) { count = 1; }));
+    ASSERT_TRUE(!counters.contains(9));
+}
+
 TEST (HashMapTesting, EmplaceElements) {
     fefu::hash_map<int, char> a;
    a.emplace(10,'s');
@@ -149,6 +176,271 @@ TEST (HashMapTesting, EmplaceElements) {
 
 }
 
+TEST (HashMapTesting, MoveOnlyMappedTypeTest) {
+    fefu::hash_map<int, std::unique_ptr<int>> a;
+    a.insert({1, std::unique_ptr<int>(new int(10))});
+    a.emplace(2, std::unique_ptr<int>(new int(20)));
+    a.try_emplace(3, new int(30));
+    a.insert_or_assign(4, std::unique_ptr<int>(new int(40)));
+    a[5] = std::unique_ptr<int>(new int(50));
+
+    //existing key: try_emplace leaves its argument untouched
+    std::unique_ptr<int> spare(new int(0));
+    ASSERT_FALSE(a.try_emplace(1, std::move(spare)).second);
+    ASSERT_TRUE(spare != nullptr);
+
+    for(int i = 6; i < 200; i++)
+        a.emplace(i, std::unique_ptr<int>(new int(i * 10)));
+
+    ASSERT_TRUE(a.size() == 199);
+    for(int i = 1; i < 200; i++)
+        ASSERT_TRUE(*a.at(i) == i * 10);
+}
+
+//counts copies of the mapped value
+struct copy_counter {
+    static int copies;
+
+    copy_counter() {}
+    copy_counter(const copy_counter&) { copies++; }
+    copy_counter(copy_counter&&) noexcept {}
+    copy_counter& operator=(const copy_counter&) { copies++; return *this; }
+    copy_counter& operator=(copy_counter&&) noexcept { return *this; }
+};
+
+int copy_counter::copies = 0;
+
+TEST (HashMapTesting, NoCopiesOnMovePathsTest) {
+    copy_counter::copies = 0;
+    fefu::hash_map<int, copy_counter> a;
+    for(int i = 0; i < 100; i++)
+        a.insert({i, copy_counter()});
+    for(int i = 100; i < 200; i++)
+        a.emplace(i, copy_counter());
+    for(int i = 200; i < 300; i++)
+        a[i] = copy_counter();
+    for(int i = 0; i < 300; i++)
+        a.insert_or_assign(i, copy_counter());
+    a.rehash(4096);
+
+    fefu::hash_map<int, copy_counter> b;
+    b.emplace(1000, copy_counter());
+    a.merge(std::move(b));
+
+    ASSERT_TRUE(a.size() == 301);
+    ASSERT_TRUE(copy_counter::copies == 0);
+}
+
+//stateful allocator for tests, all copies share one byte counter
+template<typename T>
+class tracking_allocator {
+public:
+    using value_type = T;
+
+    explicit tracking_allocator(long* live_bytes) : live_bytes(live_bytes) {}
+
+    template<typename U>
+    tracking_allocator(const tracking_allocator<U>& other) : live_bytes(other.live_bytes) {}
+
+    T* allocate(std::size_t n) {
+        *live_bytes += n * sizeof(T);
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) {
+        *live_bytes -= n * sizeof(T);
+        ::operator delete(p);
+    }
+
+    long* live_bytes;
+};
+
+template<typename T, typename U>
+bool operator==(const tracking_allocator<T>& l, const tracking_allocator<U>& r) {
+    return l.live_bytes == r.live_bytes;
+}
+
+template<typename T, typename U>
+bool operator!=(const tracking_allocator<T>& l, const tracking_allocator<U>& r) {
+    return !(l == r);
+}
+
+TEST (HashMapTesting, AllocatorAwareTest) {
+    using tracked_map = fefu::hash_map<int, int, fefu::FirstKeyHash<int>, fefu::SecondKeyHash<int>,
+            std::equal_to<int>, tracking_allocator<std::pair<const int, int>*>>;
+    long first_bytes = 0;
+    long second_bytes = 0;
+    {
+        tracked_map a{tracking_allocator<std::pair<const int, int>*>(&first_bytes)};
+        for(int i = 0; i < 100; i++)
+            a.insert({i, i});
+        //the nodes plus one cache line per slot group and a spare line for alignment
+        using group = tracked_map::iterator::group_type;
+        ASSERT_TRUE(sizeof(group) == group::line_size);
+        ASSERT_TRUE(first_bytes == (long)(100 * sizeof(fefu::hash_map_node<std::pair<const int, int>>)
+                                          + (a.max_size() / group::width + 1) * group::line_size));
+
+        tracked_map b(a);
+        ASSERT_TRUE(b.size() == 100);
+        ASSERT_TRUE(b.get_allocator() == a.get_allocator());
+
+        tracked_map c{tracking_allocator<std::pair<const int, int>*>(&second_bytes)};
+        long before = second_bytes;
+        auto node = a.extract(7);
+        ASSERT_TRUE(node.get_allocator() == a.get_allocator());
+        c.insert(std::move(node));
+        ASSERT_TRUE(c.contains(7));
+        ASSERT_TRUE(second_bytes > before);
+
+        c.merge(b);
+        ASSERT_TRUE(c.size() == 100);
+        ASSERT_TRUE(b.size() == 1);
+
+        c = std::move(a);
+        ASSERT_TRUE(c.size() == 99);
+        ASSERT_TRUE(!c.contains(7));
+    }
+    ASSERT_TRUE(first_bytes == 0);
+    ASSERT_TRUE(second_bytes == 0);
+}
+
+TEST (HashMapTesting, NodePoolAllocatorTest) {
+    using pool_map = fefu::hash_map<int, int, fefu::FirstKeyHash<int>, fefu::SecondKeyHash<int>,
+            std::equal_to<int>, fefu::node_pool_allocator<std::pair<const int, int>*>>;
+    pool_map a;
+    for(int i = 0; i < 1000; i++)
+        a.insert({i, i});
+
+    auto nodes = pool_map::node_allocator_type(a.get_allocator());
+    ASSERT_TRUE(nodes.allocated() == 1000);
+
+    //nodes inserted together are neighbours in a slab
+    ASSERT_TRUE((char*)&(*a.find(1))->first - (char*)&(*a.find(0))->first == sizeof(fefu::hash_map_node<std::pair<const int, int>>));
+
+    //freed nodes are recycled
+    std::pair<const int, int>* freed = *a.find(500);
+    a.erase(500);
+    a.insert({5000, 1});
+    ASSERT_TRUE(*a.find(5000) == freed);
+
+    //an extracted node keeps the pool from being released
+    auto node = a.extract(7);
+    a.clear();
+    ASSERT_TRUE(nodes.allocated() == 1);
+    ASSERT_TRUE(node.mapped() == 7);
+
+    pool_map b(a.get_allocator());
+    b.insert(std::move(node));
+    ASSERT_TRUE(b.contains(7));
+
+    //a copy gets a pool of its own
+    pool_map c(b);
+    ASSERT_TRUE(c.get_allocator() != b.get_allocator());
+    ASSERT_TRUE(decltype(nodes)(c.get_allocator()).allocated() == 1);
+
+    b.clear();
+    ASSERT_TRUE(nodes.allocated() == 0);
+
+    //the sibling maps keep their own pool on copy assignment and take the other's on move assignment
+    using pool_linear_map = fefu::linear_hash_map<int, int, fefu::FirstKeyHash<int>, fefu::SecondKeyHash<int>,
+            std::equal_to<int>, fefu::node_pool_allocator<std::pair<const int, int>*>>;
+    pool_linear_map d;
+    pool_linear_map e;
+    e.insert({1, 1});
+    auto pool = d.get_allocator();
+    d = e;
+    ASSERT_TRUE(d.get_allocator() == pool && d.at(1) == 1);
+    d = std::move(e);
+    ASSERT_TRUE(d.get_allocator() != pool && d.at(1) == 1);
+}
+
+//monotonic arena that counts the calls it receives
+struct counting_arena : fefu::monotonic_arena {
+    int deallocations = 0;
+
+    void deallocate(void* p, std::size_t bytes, std::size_t alignment) {
+        deallocations++;
+        fefu::monotonic_arena::deallocate(p, bytes, alignment);
+    }
+};
+
+namespace fefu {
+    template<>
+    struct is_monotonic_resource<counting_arena> : std::true_type {};
+}
+
+TEST (HashMapTesting, MonotonicArenaTest) {
+    using arena_map = fefu::hash_map<int, int, fefu::FirstKeyHash<int>, fefu::SecondKeyHash<int>,
+            std::equal_to<int>, fefu::arena_allocator<std::pair<const int, int>*, counting_arena>>;
+    counting_arena arena;
+    {
+        arena_map a(&arena);
+        for(int i = 0; i < 1000; i++)
+            a.insert({i, i});
+        for(int i = 0; i < 1000; i++)
+            ASSERT_TRUE(a.at(i) == i);
+        arena.deallocations = 0;
+    }
+    //only the slot groups are handed back, nodes are not visited
+    ASSERT_TRUE(arena.deallocations == 1);
+
+    fefu::monotonic_arena strings_arena;
+    {
+        fefu::hash_map<int, std::string, fefu::FirstKeyHash<int>, fefu::SecondKeyHash<int>,
+                std::equal_to<int>, fefu::arena_allocator<std::pair<const int, std::string>*>> b(&strings_arena);
+        for(int i = 0; i < 100; i++)
+            b.insert({i, std::string(100, 'x')});
+        ASSERT_TRUE(b.at(42).size() == 100);
+    }
+    strings_arena.release();
+}
+
+TEST (HashMapTesting, HugePageTableTest) {
+    fefu::hash_map<int, int> a;
+    ASSERT_TRUE(a.backing() == fefu::table_backing::embedded);
+
+    a.huge_page_threshold(4096);
+    for(int i = 0; i < 10000; i++)
+        a.insert({i, i});
+    ASSERT_TRUE(a.backing() != fefu::table_backing::allocator);
+    for(int i = 0; i < 10000; i++)
+        ASSERT_TRUE(a.at(i) == i);
+
+    fefu::hash_map<int, int> b(a);
+    ASSERT_TRUE(b.backing() != fefu::table_backing::allocator);
+    ASSERT_TRUE(b.size() == 10000);
+
+    //small tables stay with the allocator
+    a.clear();
+    ASSERT_TRUE(a.backing() == fefu::table_backing::embedded);
+    for(int i = 0; i < 100; i++)
+        a.insert({i, i});
+    ASSERT_TRUE(a.backing() == fefu::table_backing::allocator);
+    ASSERT_TRUE(a.at(1) == 1);
+}
+
+TEST (HashMapTesting, MemoryUsageTest) {
+    fefu::hash_map<int, long> a;
+    for(int i = 0; i < 20; i++)
+        a.insert({i, i});
+    a.erase(3);
+    a.erase(4);
+
+    auto usage = a.memory_usage();
+    size_t groups = a.max_size() / fefu::hash_map_slot_group<std::pair<const int, long>>::width;
+    ASSERT_TRUE(usage.table == a.max_size() * sizeof(void*));
+    ASSERT_TRUE(usage.table + usage.metadata == (groups + 1) * 64);
+    ASSERT_TRUE(usage.nodes == 18 * sizeof(fefu::hash_map_node<std::pair<const int, long>>));
+    ASSERT_TRUE(usage.tombstones == 2 * sizeof(void*));
+    ASSERT_TRUE(usage.slack == (a.max_size() - 18) * sizeof(void*) + 64);
+    ASSERT_TRUE(usage.total() == usage.table + usage.metadata + usage.nodes);
+    ASSERT_TRUE(usage.backing == fefu::table_backing::allocator);
+
+    a.clear();
+    ASSERT_TRUE(a.memory_usage().nodes == 0);
+    ASSERT_TRUE(a.memory_usage().tombstones == 0);
+}
+
 TEST (HashMapTesting, EraseElements) {
     fefu::hash_map<int, char> a;
     a.insert({10, 's'});
@@ -207,6 +499,55 @@ TEST (HashMapTesting, EraseElementsByPosition) {
 }
 
 
+TEST (HashMapTesting, EraseReturnsNextPosition) {
+    fefu::hash_map<int, char> a;
+    for(int i = 0; i < 10; i++)
+        a.insert({i, 'a'});
+
+    int visited = 0;
+    for(auto it = a.begin(); it != a.end(); ) {
+        if((*it)->first % 2 == 0)
+            it = a.erase(it);
+        else {
+            ++it;
+            visited++;
+        }
+    }
+    ASSERT_TRUE(visited == 5);
+    ASSERT_TRUE(a.size() == 5);
+    ASSERT_TRUE(!a.contains(4));
+    ASSERT_TRUE(a.contains(5));
+
+    a.erase(a.cbegin(), a.cend());
+    ASSERT_TRUE(a.empty());
+}
+
+TEST (HashMapTesting, EraseIfTest) {
+    fefu::hash_map<int, int> a;
+    for(int i = 1; i <= 1000; i++)
+        a.insert({i * 3, i});
+
+    auto erased = fefu::erase_if(a, [](const std::pair<const int, int>& value) {
+        return value.second % 10 < 7;
+    });
+
+    ASSERT_TRUE(erased == 700);
+    ASSERT_TRUE(a.size() == 300);
+    for(int i = 1; i <= 1000; i++)
+        ASSERT_TRUE(a.contains(i * 3) == (i % 10 >= 7));
+
+    //tombstones are reclaimed and the table keeps working
+    for(int round = 0; round < 5; round++) {
+        fefu::erase_if(a, [](const std::pair<const int, int>&) { return true; });
+        ASSERT_TRUE(a.empty());
+        for(int i = 1; i <= 1000; i++)
+            a.insert({i * 3, i});
+        ASSERT_TRUE(a.size() == 1000);
+    }
+    for(int i = 1; i <= 1000; i++)
+        ASSERT_TRUE((*a.find(i * 3))->second == i);
+}
+
 TEST (HashMapTesting, BracketsOperator) {
     fefu::hash_map<int, char> a;
     a[5] = 's';
@@ -378,6 +719,96 @@ TEST (HashMapTesting, MergeTest) {
 
 }
 
+TEST (HashMapTesting, ExtractAndInsertNodeTest) {
+    fefu::hash_map<int, char> a;
+    a.insert({5, 's'});
+    a.insert({2, 'l'});
+    a.insert({15, 'd'});
+
+    fefu::hash_map<int, char> b;
+    b.insert({2, 'x'});
+
+    auto node = a.extract(5);
+    ASSERT_FALSE(node.empty());
+    ASSERT_TRUE(node.key() == 5);
+    ASSERT_TRUE(!a.contains(5));
+    ASSERT_TRUE(a.size() == 2);
+    char* value_address = &node.mapped();
+
+    auto result = b.insert(std::move(node));
+    ASSERT_TRUE(result.inserted);
+    ASSERT_TRUE(node.empty());
+    ASSERT_TRUE(&(*result.position)->second == value_address);
+    ASSERT_TRUE(b.contains(5));
+
+    //key is already present, node is handed back
+    auto conflict = b.insert(a.extract(a.find(2)));
+    ASSERT_FALSE(conflict.inserted);
+    ASSERT_FALSE(conflict.node.empty());
+    ASSERT_TRUE(conflict.node.mapped() == 'l');
+    ASSERT_TRUE((*conflict.position)->second == 'x');
+
+    ASSERT_TRUE(a.extract(100).empty());
+    ASSERT_TRUE(a.contains(15));
+    ASSERT_TRUE(a.size() == 1);
+}
+
+TEST (HashMapTesting, MergeStealsNodesTest) {
+    fefu::hash_map<int, char> a;
+    a.insert({5, 's'});
+    a.insert({2, 'l'});
+
+    fefu::hash_map<int, char> b;
+    b.insert({2, 'x'});
+    b.insert({205, 'p'});
+    b.insert({908, 'm'});
+    b.insert({144, 'n'});
+    b.erase(144);
+    char* value_address = &(*b.find(205))->second;
+
+    a.merge(b);
+
+    ASSERT_TRUE(a.size() == 4);
+    ASSERT_TRUE(a.contains(205));
+    ASSERT_TRUE(a.contains(908));
+    ASSERT_TRUE(&(*a.find(205))->second == value_address);
+
+    //erased elements are not resurrected
+    ASSERT_TRUE(!a.contains(144));
+
+    //conflicting keys stay in the source
+    ASSERT_TRUE((*a.find(2))->second == 'l');
+    ASSERT_TRUE(b.size() == 1);
+    ASSERT_TRUE(b.contains(2));
+    ASSERT_TRUE(!b.contains(205));
+
+    fefu::hash_map<int, char> c;
+    for(int i = 0; i < 100; i++)
+        c.insert({i * 7, 'c'});
+    a.merge(std::move(c));
+    ASSERT_TRUE(a.size() == 104);
+    ASSERT_TRUE(c.empty());
+
+    a.merge(a);
+    ASSERT_TRUE(a.size() == 104 && a.contains(205));
+
+    //tombstones count when the target is sized for the merge
+    fefu::hash_map<int, char> d;
+    for(int i = 0; i < 1000; i++)
+        d.insert({i, 'd'});
+    for(int i = 0; i < 1000; i += 10)
+        for(int j = i; j < i + 9; j++)
+            d.erase(j);
+    std::size_t tombstones = d.memory_usage().tombstones / sizeof(void*);
+    fefu::hash_map<int, char> e;
+    for(int i = 0; i < 900; i++)
+        e.insert({-1 - i, 'e'});
+    ASSERT_TRUE((float)(d.size() + e.size()) / d.max_size() < d.max_load_factor());
+    ASSERT_TRUE((float)(d.size() + tombstones + e.size()) / d.max_size() >= d.max_load_factor());
+    d.merge(e);
+    ASSERT_TRUE(d.size() == 1000 && e.empty() && d.memory_usage().tombstones == 0);
+}
+
 TEST (HashMapTesting, SwapTest) {
     fefu::hash_map<int, char> a;
     a.insert({5, 's'});
@@ -434,7 +865,6 @@ TEST (HashMapTesting, ClearAllTest) {
 
 TEST (HashMapTesting, RehashTest) {
     fefu::hash_map<int, char> a;
-    int max_size = a.max_size();
 
     a.insert({10, 's'});
     a.insert({11, 'd'});
@@ -444,6 +874,8 @@ TEST (HashMapTesting, RehashTest) {
     a.insert({4, 'l'});
     a.insert({102, 's'});
     a.insert({121, 'd'});
+    //the first hashed table, the small map is left behind
+    int max_size = a.max_size();
     a.insert({142, 'w'});
     a.insert({211, 'a'});
     a.insert({515, 'g'});
@@ -464,10 +896,835 @@ TEST (HashMapTesting, RehashTest) {
     a.insert({481, 'p'});
     a.insert({889, 'r'});
     a.insert({777, 'p'});
+    a.insert({999, 'r'});
+    a.insert({1234, 'p'});
+    a.insert({4321, 'q'});
 
     ASSERT_TRUE(2 * max_size == a.max_size());
 }
 
+TEST (HashMapTesting, SlotStateTest) {
+    using group = fefu::hash_map_slot_group<std::pair<const int, int>>;
+    fefu::hash_map<int, int> a;
+    ASSERT_TRUE(a.max_size() % group::width == 0);
+    ASSERT_TRUE(sizeof(group) == 64);
+
+    for(int round = 0; round < 5; round++) {
+        for(int i = 0; i < 1000; i++)
+            a.insert({i, i + round});
+        for(int i = 0; i < 1000; i += 2)
+            a.erase(i);
+
+        int visited = 0;
+        for(auto it = a.begin(); it != a.end(); ++it) {
+            ASSERT_TRUE(it->first % 2 == 1);
+            visited++;
+        }
+        ASSERT_TRUE(visited == 500);
+        for(int i = 1; i < 1000; i += 2)
+            ASSERT_TRUE(a.contains(i));
+    }
+    for(int i = 0; i < 1000; i++)
+        a.erase(i);
+    ASSERT_TRUE(a.begin() == a.end());
+}
+
+//hash functor that counts its calls
+struct counting_hash {
+    static int calls;
+
+    long operator()(int key, size_t table_size) const {
+        calls++;
+        return key % table_size;
+    }
+};
+
+int counting_hash::calls = 0;
+
+TEST (HashMapTesting, GroupProbeTest) {
+    //probing by groups stays correct close to a full table
+    fefu::hash_map<int, int> a;
+    a.max_load_factor(0.9);
+    for(int round = 0; round < 3; round++) {
+        for(int i = 0; i < 3000; i++)
+            a.insert({i * 7, i});
+        for(int i = 0; i < 3000; i += 3)
+            a.erase(i * 7);
+        for(int i = 0; i < 3000; i++) {
+            ASSERT_TRUE(a.contains(i * 7) == (i % 3 != 0));
+            ASSERT_TRUE(!a.contains(i * 7 + 1));
+        }
+    }
+    ASSERT_TRUE(a.size() == 2000);
+    ASSERT_TRUE(a.load_factor() == (float)a.size() / (float)a.max_size());
+    ASSERT_TRUE(a.load_factor() > 0.2 && a.load_factor() <= 0.9);
+}
+
+template<typename Policy>
+bool probe_covers_table(std::size_t groups) {
+    for(std::uint32_t seed = 0; seed < 50; seed++) {
+        fefu::hash_map_key_hash h{seed * 2654435761u, seed * 40503u + 7};
+        typename Policy::sequence probe(h, groups);
+        std::vector<bool> seen(groups, false);
+        for(std::size_t i = 0; i < groups; i++, probe.next()) {
+            if(probe.group() >= groups || seen[probe.group()])
+                return false;
+            seen[probe.group()] = true;
+        }
+    }
+    return true;
+}
+
+template<typename Policy>
+void check_probe_policy() {
+    for(std::size_t groups = 1; groups < 300; groups++)
+        ASSERT_TRUE(probe_covers_table<Policy>(groups));
+
+    fefu::hash_map<int, int, fefu::FirstKeyHash<int>, fefu::SecondKeyHash<int>, std::equal_to<int>,
+            fefu::allocator<std::pair<const int, int>*>, Policy> a;
+    a.max_load_factor(0.95);
+    for(int round = 0; round < 3; round++) {
+        for(int i = 0; i < 3000; i++)
+            a.insert({i * 7, i});
+        for(int i = 0; i < 3000; i += 3)
+            a.erase(i * 7);
+        for(int i = 0; i < 3000; i++) {
+            ASSERT_TRUE(a.contains(i * 7) == (i % 3 != 0));
+            ASSERT_TRUE(!a.contains(i * 7 + 1));
+        }
+    }
+    ASSERT_TRUE(a.size() == 2000);
+    auto b = a;
+    b.merge(a);
+    ASSERT_TRUE(b.size() == 2000 && a.size() == 2000);
+    ASSERT_TRUE(fefu::erase_if(b, [](const std::pair<const int, int>& item) { return item.second % 2 == 0; }) == 1000);
+}
+
+TEST (HashMapTesting, ProbePolicyTest) {
+    //every policy visits each group once within its first groups probes
+    check_probe_policy<fefu::linear_probe>();
+    check_probe_policy<fefu::triangular_probe>();
+    check_probe_policy<fefu::double_hash_probe>();
+}
+
+template<typename Map>
+void check_slot_probe_coverage() {
+    //keys sharing a first slot fill the table without growing it
+    Map a;
+    a.max_load_factor(0.99);
+    a.insert({1, 0});
+    std::size_t slots = a.max_size();
+    int count = 1;
+    for(; count + 1 < 0.95 * slots; count++)
+        a.insert({count * 64 + 1, count});
+    ASSERT_TRUE(a.max_size() == slots);
+    for(int i = 0; i < count; i++)
+        ASSERT_TRUE(a.at(i * 64 + 1) == i);
+    ASSERT_TRUE(!a.contains(count * 64 + 1));
+}
+
+TEST (HashMapTesting, SlotProbeCoverageTest) {
+    check_slot_probe_coverage<fefu::soa_hash_map<int, int>>();
+    check_slot_probe_coverage<fefu::integer_hash_map<int, int>>();
+    check_slot_probe_coverage<fefu::sparse_hash_map<int, int>>();
+    check_slot_probe_coverage<fefu::ordered_hash_map<int, int>>();
+}
+
+struct constant_hash {
+    long operator()(int, size_t table_size) const {
+        return 12345 % table_size;
+    }
+};
+
+// Default probe policy that counts the groups lookups read.
+struct counting_probe {
+    static std::size_t reads;
+
+    class sequence {
+    public:
+        sequence(const fefu::hash_map_key_hash& h, std::size_t groups) noexcept : inner(h, groups) {}
+
+        std::size_t group() const noexcept {
+            reads++;
+            return inner.group();
+        }
+
+        void next() noexcept {
+            inner.next();
+        }
+
+    private:
+        fefu::double_hash_probe::sequence inner;
+    };
+};
+
+std::size_t counting_probe::reads = 0;
+
+TEST (HashMapTesting, MaxProbeTest) {
+    //keys sharing one probe sequence fill its groups one after another
+    using constant_map = fefu::hash_map<int, int, constant_hash, constant_hash>;
+    const std::size_t width = constant_map::iterator::group_type::width;
+    constant_map a;
+    a.rehash(2000);
+    for(int i = 0; i < 300; i++)
+        a.insert({i, i});
+    ASSERT_TRUE(a.max_probe_length() == (300 + width - 1) / width - 1);
+    ASSERT_TRUE(a.max_probe_length() < a.max_size() / width);
+    for(int i = 0; i < 300; i += 2)
+        a.erase(i);
+    for(int i = 0; i < 600; i++)
+        ASSERT_TRUE(a.contains(i) == (i < 300 && i % 2 != 0));
+    a.insert({1000, 1000});
+    ASSERT_TRUE(a.size() == 151 && a.find(1000)->second == 1000);
+
+    //a rebuild forgets displacements of erased elements
+    for(int i = 0; i < 300; i++)
+        a.erase(i);
+    a.rehash(2000);
+    ASSERT_TRUE(a.max_probe_length() == 0 && a.contains(1000));
+
+    //in a table worn down to tombstones a miss reads at most MAX_PROBE + 1 groups
+    using counted_map = fefu::hash_map<int, std::string, fefu::FirstKeyHash<int>, fefu::SecondKeyHash<int>,
+            std::equal_to<int>, tracking_allocator<std::pair<const int, std::string>*>, counting_probe>;
+    long bytes = 0;
+    {
+        counted_map b{tracking_allocator<std::pair<const int, std::string>*>(&bytes)};
+        b.max_load_factor(0.95);
+        for(int round = 0; round < 20; round++) {
+            for(int i = 0; i < 1000; i++)
+                b.insert({round * 1000 + i, std::to_string(i)});
+            for(int i = 0; i < 1000; i++)
+                if(i % 4 != 0)
+                    b.erase(round * 1000 + i);
+        }
+        ASSERT_TRUE(b.size() == 5000);
+        std::size_t groups = b.max_size() / counted_map::iterator::group_type::width;
+        ASSERT_TRUE(b.max_probe_length() < groups);
+        for(int i = 0; i < 40000; i++) {
+            counting_probe::reads = 0;
+            ASSERT_TRUE(b.contains(i) == (i < 20000 && i % 4 == 0));
+            ASSERT_TRUE(counting_probe::reads <= b.max_probe_length() + 1);
+        }
+    }
+    ASSERT_TRUE(bytes == 0);
+}
+
+TEST (HashMapTesting, CachedHashTest) {
+    fefu::hash_map<int, int, counting_hash, counting_hash> a;
+    for(int i = 0; i < 500; i++)
+        a.insert({i, i});
+
+    //growing and compacting relink nodes by their cached hashes
+    counting_hash::calls = 0;
+    a.rehash(5000);
+    for(int i = 0; i < 500; i += 2)
+        a.erase(i);
+    counting_hash::calls = 0;
+    fefu::erase_if(a, [](const std::pair<const int, int>& item) { return item.first % 3 == 0; });
+    a.rehash(a.max_size());
+    ASSERT_TRUE(counting_hash::calls == 0);
+
+    //one lookup hashes its key with each functor once
+    ASSERT_TRUE(a.contains(1));
+    ASSERT_TRUE(counting_hash::calls == 2);
+    for(int i = 1; i < 500; i += 2)
+        ASSERT_TRUE(a.contains(i) == (i % 3 != 0));
+}
+
+struct low_bits_hash {
+    long operator()(int key, size_t) const {
+        return key & 0xFFFF;
+    }
+};
+
+TEST (HashMapTesting, FingerprintTest) {
+    // Keys 65536 apart share both hashes and so the fingerprint, so lookups
+    // fall back to key_equal.
+    fefu::hash_map<int, int, low_bits_hash, low_bits_hash> a;
+    for(int i = 0; i < 200; i++) {
+        a.insert({i, i});
+        a.insert({i + 65536, -i});
+    }
+    a.rehash(1000);
+
+    ASSERT_TRUE(a.size() == 400);
+    for(int i = 0; i < 200; i++) {
+        ASSERT_TRUE(a.find(i)->second == i);
+        ASSERT_TRUE(a.find(i + 65536)->second == -i);
+    }
+    ASSERT_TRUE(!a.contains(2 * 65536));
+
+    a.erase(7);
+    ASSERT_TRUE(!a.contains(7));
+    ASSERT_TRUE(a.contains(7 + 65536));
+
+    decltype(a) b(a);
+    for(auto it = b.begin(); it != b.end(); ++it)
+        ASSERT_TRUE(a.at(it->first) == it->second);
+}
+
+TEST (HashMapTesting, SmallMapTest) {
+    using tracked_map = fefu::hash_map<int, int, fefu::FirstKeyHash<int>, fefu::SecondKeyHash<int>,
+            std::equal_to<int>, tracking_allocator<std::pair<const int, int>*>>;
+    using node = fefu::hash_map_node<std::pair<const int, int>>;
+    long bytes = 0;
+    {
+        tracked_map a{tracking_allocator<std::pair<const int, int>*>(&bytes)};
+        ASSERT_TRUE(bytes == 0);
+        for(int i = 0; i < 7; i++)
+            a.insert({i, i});
+        //only the nodes, no table
+        ASSERT_TRUE(bytes == (long)(7 * sizeof(node)));
+        ASSERT_TRUE(a.backing() == fefu::table_backing::embedded);
+
+        //erasing leaves no tombstones, the lane is reused
+        a.erase(3);
+        a.insert({30, 30});
+        ASSERT_TRUE(a.backing() == fefu::table_backing::embedded);
+        int sum = 0;
+        for(auto it = a.begin(); it != a.end(); ++it)
+            sum += it->second;
+        ASSERT_TRUE(sum == 0 + 1 + 2 + 30 + 4 + 5 + 6);
+
+        tracked_map b(std::move(a));
+        ASSERT_TRUE(b.size() == 7);
+        ASSERT_TRUE(a.size() == 0);
+        a.insert({1, 1});
+        a.swap(b);
+        ASSERT_TRUE(a.size() == 7 && b.size() == 1);
+        ASSERT_TRUE(a.at(30) == 30 && b.at(1) == 1);
+
+        //the eighth element moves the map to a hashed table
+        a.insert({7, 7});
+        ASSERT_TRUE(a.backing() == fefu::table_backing::allocator);
+        ASSERT_TRUE(bytes > (long)(9 * sizeof(node)));
+        for(int i = 0; i < 8; i++)
+            ASSERT_TRUE(a.contains(i) == (i != 3));
+
+        //and shrinking brings it back
+        for(int i = 0; i < 6; i++)
+            a.erase(i);
+        a.rehash(0);
+        ASSERT_TRUE(a.backing() == fefu::table_backing::embedded);
+        ASSERT_TRUE(a.size() == 3 && a.at(30) == 30 && a.at(7) == 7);
+    }
+    ASSERT_TRUE(bytes == 0);
+}
+
+template<typename Map>
+void check_map_copy_and_move(Map& a, const typename Map::key_type& key) {
+    std::size_t size = a.size();
+    Map b(a);
+    ASSERT_TRUE(b.size() == size && b.at(key) == a.at(key));
+    Map c(std::move(a));
+    ASSERT_TRUE(c.size() == size && a.empty() && a.begin() == a.end());
+    a = c;
+    ASSERT_TRUE(c.erase(key) == 1);
+    ASSERT_TRUE(!c.contains(key) && a.contains(key) && b.contains(key));
+    c.clear();
+    ASSERT_TRUE(c.empty() && c.begin() == c.end() && a.size() == size);
+    ASSERT_THROW(c.at(key), std::out_of_range);
+}
+
+//copies and moves between maps whose tracking allocators count into different totals
+template<typename Map>
+void check_map_allocator_moves(const Map& a, const typename Map::key_type& key) {
+    long bytes = 0;
+    {
+        typename Map::allocator_type other(&bytes);
+        Map b(a, other);
+        ASSERT_TRUE(b.get_allocator() == other && bytes > 0);
+        ASSERT_TRUE(b.size() == a.size() && b.at(key) == a.at(key));
+        //unequal allocators, so the elements are moved one by one
+        Map c(std::move(b), a.get_allocator());
+        ASSERT_TRUE(c.get_allocator() == a.get_allocator() && c.size() == a.size() && b.empty());
+        b = std::move(c);
+        ASSERT_TRUE(b.get_allocator() == other && b.size() == a.size() && c.empty());
+        ASSERT_TRUE(b.at(key) == a.at(key));
+        c = b;
+        ASSERT_TRUE(c.get_allocator() == a.get_allocator() && c.size() == a.size());
+    }
+    ASSERT_TRUE(bytes == 0);
+}
+
+//copies fail once the shared budget runs out
+struct limited_copy {
+    limited_copy(int value, int* budget) : value(value), budget(budget) {}
+
+    limited_copy(const limited_copy& other) : value(other.value), budget(other.budget) {
+        if((*budget)-- == 0)
+            throw std::runtime_error("copy budget");
+    }
+
+    int value;
+    int* budget;
+};
+
+TEST (HashMapTesting, SoaHashMapTest) {
+    using soa_map = fefu::soa_hash_map<long long, double, fefu::FirstKeyHash<long long>,
+            fefu::SecondKeyHash<long long>, std::equal_to<long long>,
+            tracking_allocator<std::pair<const long long, double>*>>;
+    long bytes = 0;
+    {
+        soa_map a{tracking_allocator<std::pair<const long long, double>*>(&bytes)};
+        ASSERT_TRUE(bytes == 0);
+        for(long long i = 0; i < 1000; i++)
+            a.insert({i, 0.5 * i});
+        ASSERT_TRUE(a.size() == 1000);
+        for(long long i = 0; i < 1000; i += 2)
+            ASSERT_TRUE(a.erase(i) == 1);
+        ASSERT_TRUE(a.erase(0) == 0);
+
+        double sum = 0;
+        a.for_each_value([&sum](double v) { sum += v; });
+        ASSERT_TRUE(sum == 0.5 * 250000);
+
+        int visited = 0;
+        for(auto it = a.begin(); it != a.end(); ++it) {
+            ASSERT_TRUE(it->first % 2 == 1);
+            ASSERT_TRUE(it->second == 0.5 * it->first);
+            it->second = 1;
+            visited++;
+        }
+        ASSERT_TRUE(visited == 500);
+
+        a[2000] += 3;
+        ASSERT_TRUE(a.at(2000) == 3);
+        ASSERT_TRUE(a.at(999) == 1);
+        ASSERT_THROW(a.at(998), std::out_of_range);
+        ASSERT_TRUE(!a.try_emplace(2000, 7.0).second);
+        ASSERT_TRUE(!a.emplace(2000LL, 7.0).second && a.emplace(3000LL, 7.0).second);
+        ASSERT_TRUE(!a.insert_or_assign(3000, 8.0).second && a.at(3000) == 8.0);
+        ASSERT_TRUE(a.insert_or_assign(4000, 9.0).second && a.erase(3000) == 1 && a.erase(4000) == 1);
+
+        const soa_map& ca = a;
+        double total = 0;
+        for(auto it = ca.begin(); it != ca.end(); ++it)
+            total += (*it).second;
+        ASSERT_TRUE(total == 503);
+
+        check_map_allocator_moves(a, 2000LL);
+        check_map_copy_and_move(a, 2000LL);
+    }
+    ASSERT_TRUE(bytes == 0);
+
+    //a rehash whose copies throw keeps the old table
+    int budget = 1000;
+    fefu::soa_hash_map<int, limited_copy> d;
+    for(int i = 0; i < 50; i++)
+        d.try_emplace(i, i, &budget);
+    budget = 10;
+    std::size_t slots = d.max_size();
+    ASSERT_THROW(d.rehash(1000), std::runtime_error);
+    ASSERT_TRUE(d.size() == 50 && d.max_size() == slots);
+    for(int i = 0; i < 50; i++)
+        ASSERT_TRUE(d.at(i).value == i);
+    budget = 100;
+    d.rehash(1000);
+    ASSERT_TRUE(d.size() == 50 && d.at(49).value == 49);
+}
+
+TEST (HashMapTesting, IntegerHashMapTest) {
+    fefu::integer_hash_map<int, std::string> a;
+    for(int i = -500; i < 500; i++)
+        a.insert({i, std::to_string(i)});
+    for(int i = -500; i < 500; i += 3)
+        ASSERT_TRUE(a.erase(i) == 1);
+    for(int i = -500; i < 500; i++)
+        ASSERT_TRUE(a.contains(i) == ((i + 500) % 3 != 0));
+
+    //sentinel keys live in the side slots
+    int empty_key = a.empty_key();
+    int deleted_key = a.deleted_key();
+    ASSERT_TRUE(!a.contains(empty_key));
+    std::size_t before = a.size();
+    a[empty_key] = "empty";
+    a.insert({deleted_key, "deleted"});
+    ASSERT_TRUE(a.size() == before + 2);
+    a.rehash(4096);
+    ASSERT_TRUE(a.at(empty_key) == "empty");
+    ASSERT_TRUE(a.find(deleted_key)->second == "deleted");
+
+    std::size_t visited = 0;
+    for(auto it = a.begin(); it != a.end(); ++it) {
+        ASSERT_TRUE(a.at(it->first) == it->second);
+        visited++;
+    }
+    ASSERT_TRUE(visited == a.size());
+
+    fefu::integer_hash_map<int, std::string> b(a);
+    ASSERT_TRUE(a.erase(empty_key) == 1);
+    ASSERT_TRUE(!a.contains(empty_key) && b.at(empty_key) == "empty");
+    ASSERT_TRUE(b.size() == a.size() + 1);
+    check_map_copy_and_move(b, empty_key);
+
+    //custom sentinels
+    fefu::integer_hash_map<unsigned, int> c(0, 1);
+    for(unsigned i = 0; i < 100; i++)
+        c[i] = i;
+    ASSERT_TRUE(c.size() == 100 && c.at(0) == 0 && c.at(1) == 1 && c.at(99) == 99);
+    ASSERT_THROW((fefu::integer_hash_map<int, int>(5, 5)), std::invalid_argument);
+
+    //a rehash whose copies throw keeps the old table, side slots included
+    int budget = 1000;
+    fefu::integer_hash_map<int, limited_copy> d;
+    for(int i = 0; i < 50; i++)
+        d.try_emplace(i, i, &budget);
+    d.try_emplace(d.deleted_key(), -1, &budget);
+    budget = 50;
+    std::size_t slots = d.max_size();
+    ASSERT_THROW(d.rehash(1000), std::runtime_error);
+    ASSERT_TRUE(d.size() == 51 && d.max_size() == slots);
+    ASSERT_TRUE(d.at(d.deleted_key()).value == -1);
+    for(int i = 0; i < 50; i++)
+        ASSERT_TRUE(d.at(i).value == i);
+    budget = 100;
+    d.rehash(1000);
+    ASSERT_TRUE(d.size() == 51 && d.at(d.deleted_key()).value == -1);
+}
+
+TEST (HashMapTesting, CompactHashMapTest) {
+    using compact_map = fefu::compact_hash_map<int, std::string, fefu::FirstKeyHash<int>,
+            fefu::SecondKeyHash<int>, std::equal_to<int>, tracking_allocator<std::pair<const int, std::string>*>>;
+    using group = fefu::hash_map_slot_group<fefu::hash_map_node<std::pair<const int, std::string>>, std::uint32_t>;
+    ASSERT_TRUE(sizeof(group) == 64);
+    ASSERT_TRUE(group::width == 14);
+
+    long bytes = 0;
+    {
+        compact_map a{tracking_allocator<std::pair<const int, std::string>*>(&bytes)};
+        for(int i = 0; i < 2000; i++)
+            a.insert({i, std::to_string(i)});
+        const std::string* element = &a.at(1999);
+        for(int i = 0; i < 2000; i += 2)
+            ASSERT_TRUE(a.erase(i) == 1);
+        //erased nodes are reused, the others never move
+        for(int i = 0; i < 2000; i += 2)
+            a[i] = std::to_string(-i);
+        ASSERT_TRUE(&a.at(1999) == element);
+        for(int i = 0; i < 2000; i++)
+            ASSERT_TRUE(a.at(i) == std::to_string(i % 2 ? i : -i));
+
+        int visited = 0;
+        for(auto it = a.begin(); it != a.end(); ++it) {
+            ASSERT_TRUE(a.at(it->first) == it->second);
+            visited++;
+        }
+        ASSERT_TRUE(visited == 2000);
+
+        auto usage = a.memory_usage();
+        ASSERT_TRUE(usage.table == a.max_size() * sizeof(std::uint32_t));
+
+        check_map_allocator_moves(a, 7);
+        check_map_copy_and_move(a, 7);
+    }
+    ASSERT_TRUE(bytes == 0);
+}
+
+struct throw_on_negative {
+    explicit throw_on_negative(int n) : text(std::to_string(n)) {
+        if(n < 0)
+            throw std::invalid_argument("negative");
+    }
+
+    std::string text;
+};
+
+TEST (HashMapTesting, SparseHashMapTest) {
+    using sparse_map = fefu::sparse_hash_map<int, std::string, fefu::FirstKeyHash<int>,
+            fefu::SecondKeyHash<int>, std::equal_to<int>, tracking_allocator<std::pair<const int, std::string>*>>;
+    using group = fefu::sparse_hash_map_group<std::pair<const int, std::string>>;
+    ASSERT_TRUE(sizeof(group) * 8 / group::width == 4);
+
+    long bytes = 0;
+    {
+        sparse_map a{tracking_allocator<std::pair<const int, std::string>*>(&bytes)};
+        ASSERT_TRUE(a.max_size() == 0 && a.begin() == a.end());
+        for(int i = 0; i < 2000; i++)
+            ASSERT_TRUE(a.insert({i, std::to_string(i)}).second);
+        ASSERT_TRUE(!a.insert({5, "x"}).second && a.at(5) == "5");
+        ASSERT_TRUE(a.max_size() % group::width == 0);
+        for(int i = 0; i < 2000; i += 2)
+            ASSERT_TRUE(a.erase(i) == 1);
+        ASSERT_TRUE(a.erase(0) == 0 && a.size() == 1000);
+        for(int i = 0; i < 2000; i++)
+            ASSERT_TRUE(a.contains(i) == (i % 2 == 1));
+        for(int i = 0; i < 2000; i += 2)
+            a[i] = std::to_string(-i);
+        for(int i = 0; i < 2000; i++)
+            ASSERT_TRUE(a.at(i) == std::to_string(i % 2 ? i : -i));
+
+        int visited = 0;
+        for(auto it = a.begin(); it != a.end(); ++it) {
+            ASSERT_TRUE(a.at(it->first) == it->second);
+            visited++;
+        }
+        ASSERT_TRUE(visited == 2000);
+
+        //only the bitmaps and item pointers are paid per slot
+        auto usage = a.memory_usage();
+        ASSERT_TRUE(usage.nodes == 2000 * sizeof(std::pair<const int, std::string>));
+        ASSERT_TRUE(usage.table + usage.metadata == a.max_size() / group::width * sizeof(group));
+
+        a.rehash(10000);
+        ASSERT_TRUE(a.size() == 2000 && a.at(1998) == "-1998");
+        check_map_allocator_moves(a, 7);
+        check_map_copy_and_move(a, 7);
+    }
+    ASSERT_TRUE(bytes == 0);
+
+    //a throwing constructor leaves the other elements of its group alone
+    fefu::sparse_hash_map<int, throw_on_negative> d;
+    for(int i = 0; i < 20; i++)
+        d.try_emplace(i, i);
+    ASSERT_THROW(d.try_emplace(1000, -1), std::invalid_argument);
+    ASSERT_TRUE(d.size() == 20 && !d.contains(1000));
+    for(int i = 0; i < 20; i++)
+        ASSERT_TRUE(d.at(i).text == std::to_string(i));
+}
+
+TEST (HashMapTesting, DirectHashMapTest) {
+    using direct_map = fefu::direct_hash_map<int, std::string, tracking_allocator<std::pair<const int, std::string>*>>;
+    long bytes = 0;
+    {
+        direct_map a(-100, 899, tracking_allocator<std::pair<const int, std::string>*>(&bytes));
+        ASSERT_TRUE(a.max_size() == 1000 && a.min_key() == -100 && a.max_key() == 899);
+        ASSERT_TRUE(bytes == 0 && a.begin() == a.end() && !a.contains(5));
+        for(int i = -100; i < 900; i += 3)
+            ASSERT_TRUE(a.insert({i, std::to_string(i)}).second);
+        ASSERT_TRUE(!a.insert({-100, "x"}).second && a.at(-100) == "-100");
+        ASSERT_THROW(a.insert({900, "x"}), std::out_of_range);
+        ASSERT_THROW(a[-101], std::out_of_range);
+        ASSERT_THROW(a.emplace(900, "x"), std::out_of_range);
+        ASSERT_TRUE(!a.emplace(-100, "x").second && a.emplace(-99, "-99").second);
+        ASSERT_TRUE(!a.insert_or_assign(-99, "y").second && a.at(-99) == "y");
+        ASSERT_TRUE(a.insert_or_assign(-98, "-98").second && a.erase(-99) == 1 && a.erase(-98) == 1);
+        ASSERT_TRUE(!a.contains(-101) && !a.contains(900) && a.erase(1000) == 0);
+        ASSERT_TRUE(a.size() == 334);
+
+        const std::string* element = &a.at(899);
+        for(int i = -100; i < 900; i++)
+            a[i] += "!";
+        ASSERT_TRUE(&a.at(899) == element && a.at(-99) == "!" && a.at(-97) == "-97!");
+
+        //iteration is in key order
+        int expected = -100;
+        for(auto it = a.begin(); it != a.end(); ++it)
+            ASSERT_TRUE(it->first == expected++);
+        ASSERT_TRUE(expected == 900);
+
+        for(auto it = a.begin(); it != a.end();)
+            it = it->first % 2 ? a.erase(it) : ++it;
+        ASSERT_TRUE(a.size() == 500 && a.contains(0) && !a.contains(1));
+
+        auto usage = a.memory_usage();
+        ASSERT_TRUE(usage.table == 1000 * sizeof(std::string) && usage.metadata == 16 * sizeof(std::uint64_t));
+
+        check_map_allocator_moves(a, -100);
+        check_map_copy_and_move(a, -100);
+        ASSERT_TRUE(a.min_key() == -100 && a.at(2) == "2!");
+    }
+    ASSERT_TRUE(bytes == 0);
+    ASSERT_THROW((fefu::direct_hash_map<int, int>(5, 4)), std::invalid_argument);
+    fefu::direct_hash_map<std::uint8_t, int> d(0, 255);
+    d[255] = 1;
+    d[0] = 2;
+    ASSERT_TRUE(d.size() == 2 && d.max_size() == 256 && d.at(255) == 1);
+
+    //keys narrower than int across zero
+    fefu::direct_hash_map<short, int> e(-10, 10);
+    for(short i = -10; i <= 10; i++)
+        e[i] = i;
+    ASSERT_TRUE(e.size() == 21 && e.at(5) == 5 && e.at(-10) == -10);
+    ASSERT_TRUE(!e.contains(-11) && !e.contains(11) && e.begin()->first == -10);
+    fefu::direct_hash_map<signed char, int> f(-128, 127);
+    f[0] = 1;
+    f[-128] = 2;
+    f[127] = 3;
+    ASSERT_TRUE(f.size() == 3 && f.max_size() == 256 && f.at(0) == 1 && f.at(127) == 3);
+}
+
+TEST (HashMapTesting, OrderedHashMapTest) {
+    using ordered_map = fefu::ordered_hash_map<int, std::string, fefu::FirstKeyHash<int>,
+            fefu::SecondKeyHash<int>, std::equal_to<int>, tracking_allocator<std::pair<const int, std::string>*>>;
+    long bytes = 0;
+    {
+        ordered_map a{tracking_allocator<std::pair<const int, std::string>*>(&bytes)};
+        ASSERT_TRUE(bytes == 0 && a.begin() == a.end());
+        //keys in an order no hash would produce
+        std::vector<int> order;
+        for(int i = 0; i < 3000; i++)
+            order.push_back((i * 7919) % 3001);
+        for(int key : order)
+            ASSERT_TRUE(a.insert({key, std::to_string(key)}).second);
+        ASSERT_TRUE(a.size() == 3000 && a.index_width() == 2);
+        ASSERT_TRUE(!a.insert({order[5], "x"}).second && a.at(order[5]) == std::to_string(order[5]));
+
+        std::size_t i = 0;
+        for(auto it = a.begin(); it != a.end(); ++it)
+            ASSERT_TRUE(it->first == order[i++]);
+        ASSERT_TRUE(i == order.size());
+
+        //erased keys come back at the end, holes are skipped
+        for(std::size_t j = 0; j < order.size(); j += 2)
+            ASSERT_TRUE(a.erase(order[j]) == 1);
+        ASSERT_TRUE(a.erase(order[0]) == 0);
+        a[order[0]] = "back";
+        std::vector<int> expected;
+        for(std::size_t j = 1; j < order.size(); j += 2)
+            expected.push_back(order[j]);
+        expected.push_back(order[0]);
+        i = 0;
+        for(auto it = a.begin(); it != a.end(); ++it)
+            ASSERT_TRUE(it->first == expected[i++]);
+        ASSERT_TRUE(i == expected.size() && a.at(order[0]) == "back");
+
+        //compaction on growth keeps the order
+        for(int key = 5000; key < 6000; key++)
+            a[key] = "";
+        i = 0;
+        auto it = a.begin();
+        for(; i < expected.size(); ++it)
+            ASSERT_TRUE(it->first == expected[i++]);
+        ASSERT_TRUE(it->first == 5000);
+
+        for(auto jt = a.begin(); jt != a.end();)
+            jt = jt->first >= 5000 ? a.erase(jt) : ++jt;
+        ASSERT_TRUE(a.size() == expected.size() && !a.contains(5500));
+
+        auto usage = a.memory_usage();
+        ASSERT_TRUE(usage.table == a.max_size() * a.index_width());
+
+        check_map_allocator_moves(a, order[1]);
+        check_map_copy_and_move(a, order[1]);
+        ASSERT_TRUE(a.begin()->first == expected[0]);
+    }
+    ASSERT_TRUE(bytes == 0);
+    fefu::ordered_hash_map<int, int, fefu::FirstKeyHash<int>, fefu::SecondKeyHash<int>> small{{3, 0}, {1, 0}, {2, 0}};
+    ASSERT_TRUE(small.index_width() == 1 && small.begin()->first == 3);
+
+    //a copy whose element copies throw frees what it built
+    int budget = 1000;
+    fefu::ordered_hash_map<int, limited_copy> d;
+    for(int i = 0; i < 50; i++)
+        d.try_emplace(i, i, &budget);
+    budget = 10;
+    ASSERT_THROW((fefu::ordered_hash_map<int, limited_copy>(d)), std::runtime_error);
+    ASSERT_TRUE(d.size() == 50 && d.at(49).value == 49);
+}
+
+TEST (HashMapTesting, ExtendibleHashMapTest) {
+    using extendible_map = fefu::extendible_hash_map<int, std::string, fefu::FirstKeyHash<int>,
+            fefu::SecondKeyHash<int>, std::equal_to<int>, tracking_allocator<std::pair<const int, std::string>*>>;
+    long bytes = 0;
+    {
+        extendible_map a{tracking_allocator<std::pair<const int, std::string>*>(&bytes)};
+        ASSERT_TRUE(bytes == 0 && a.begin() == a.end() && !a.contains(1));
+        a[0] = "0";
+        const std::string* element = &a.at(0);
+
+        //growth adds one segment at a time and never moves elements
+        for(int i = 1; i < 20000; i++) {
+            std::size_t segments = a.segment_count();
+            ASSERT_TRUE(a.insert({i, std::to_string(i)}).second);
+            ASSERT_TRUE(a.segment_count() - segments <= 1);
+        }
+        ASSERT_TRUE(&a.at(0) == element && a.size() == 20000);
+        ASSERT_TRUE(a.segment_count() > 64 && (std::size_t(1) << a.global_depth()) >= a.segment_count());
+        ASSERT_TRUE(a.load_factor() > 0.3 && a.load_factor() <= a.max_load_factor());
+        ASSERT_TRUE(!a.insert({7, "x"}).second && a.at(7) == "7");
+
+        for(int i = 0; i < 20000; i += 2)
+            ASSERT_TRUE(a.erase(i) == 1);
+        ASSERT_TRUE(a.erase(0) == 0 && a.size() == 10000);
+        for(int i = 0; i < 20000; i++)
+            ASSERT_TRUE(a.contains(i) == (i % 2 == 1));
+
+        int visited = 0;
+        for(auto it = a.begin(); it != a.end(); ++it) {
+            ASSERT_TRUE(it->first % 2 == 1 && a.at(it->first) == it->second);
+            visited++;
+        }
+        ASSERT_TRUE(visited == 10000);
+
+        auto usage = a.memory_usage();
+        ASSERT_TRUE(usage.nodes == 10000 * sizeof(fefu::hash_map_node<std::pair<const int, std::string>>));
+
+        std::size_t segments = a.segment_count();
+        check_map_allocator_moves(a, 7);
+        check_map_copy_and_move(a, 7);
+        ASSERT_TRUE(a.segment_count() == segments && a.at(19999) == "19999");
+    }
+    ASSERT_TRUE(bytes == 0);
+
+    //load factors past 1 still leave every segment an empty slot
+    fefu::extendible_hash_map<int, int> d;
+    d.max_load_factor(1.5);
+    for(int i = 0; i < 2000; i++)
+        d.insert({i, i});
+    for(int i = 0; i < 2000; i += 2)
+        d.erase(i);
+    ASSERT_TRUE(d.size() == 1000 && d.segment_count() > 4);
+    for(int i = 0; i < 2000; i++)
+        ASSERT_TRUE(d.contains(i) == (i % 2 == 1));
+}
+
+TEST (HashMapTesting, LinearHashMapTest) {
+    using linear_map = fefu::linear_hash_map<int, std::string, fefu::FirstKeyHash<int>,
+            fefu::SecondKeyHash<int>, std::equal_to<int>, tracking_allocator<std::pair<const int, std::string>*>>;
+    long bytes = 0;
+    {
+        linear_map a{tracking_allocator<std::pair<const int, std::string>*>(&bytes)};
+        ASSERT_TRUE(bytes == 0 && a.begin() == a.end() && !a.contains(1));
+        ASSERT_TRUE(a.emplace(0, "x").second && !a.emplace(0, "y").second);
+        ASSERT_TRUE(!a.insert_or_assign(0, "0").second && a.at(0) == "0");
+        const std::string* element = &a.at(0);
+
+        //one split per insert at most, capacity tracks the size
+        for(int i = 1; i < 20000; i++) {
+            std::size_t buckets = a.max_size();
+            ASSERT_TRUE(a.insert({i, std::to_string(i)}).second);
+            ASSERT_TRUE(a.max_size() - buckets <= 1);
+            ASSERT_TRUE(a.load_factor() <= a.max_load_factor());
+        }
+        ASSERT_TRUE(&a.at(0) == element && a.size() == 20000 && a.max_size() == 20000);
+        ASSERT_TRUE(!a.insert({7, "x"}).second && a.at(7) == "7");
+
+        for(int i = 0; i < 20000; i += 2)
+            ASSERT_TRUE(a.erase(i) == 1);
+        ASSERT_TRUE(a.erase(0) == 0 && a.size() == 10000);
+        for(int i = 0; i < 20000; i++)
+            ASSERT_TRUE(a.contains(i) == (i % 2 == 1));
+
+        int visited = 0;
+        for(auto it = a.begin(); it != a.end(); ++it) {
+            ASSERT_TRUE(a.at(it->first) == it->second);
+            visited++;
+        }
+        ASSERT_TRUE(visited == 10000);
+        for(auto it = a.begin(); it != a.end();)
+            it = it->first % 4 == 1 ? a.erase(it) : ++it;
+        ASSERT_TRUE(a.size() == 5000 && a.contains(3) && !a.contains(5));
+
+        a.max_load_factor(0.5);
+        ASSERT_TRUE(a.max_size() == 20000);
+        a.reserve(30000);
+        ASSERT_TRUE(a.max_size() == 60000 && a.at(3) == "3");
+
+        auto usage = a.memory_usage();
+        ASSERT_TRUE(usage.nodes == 5000 * sizeof(fefu::linear_hash_map_node<std::pair<const int, std::string>>));
+
+        linear_map b(a);
+        ASSERT_TRUE(b.max_size() == a.max_size());
+        b[100003] = "new";
+        ASSERT_TRUE(b.at(100003) == "new" && !a.contains(100003));
+        check_map_allocator_moves(a, 3);
+        check_map_copy_and_move(a, 3);
+        ASSERT_TRUE(a.at(19999) == "19999");
+    }
+    ASSERT_TRUE(bytes == 0);
+}
+
 //custom_class for tests
 class my_class {
 public: